@@ -0,0 +1,55 @@
+#include "BeamProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+Load< BeamProgram > beam_program(LoadTagEarly);
+
+BeamProgram::BeamProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"in vec4 Position;\n"
+		"in vec4 Color;\n"
+		"in float Distance;\n"
+		"out vec4 color;\n"
+		"out float distance;\n"
+		"void main() {\n"
+		"	gl_Position = OBJECT_TO_CLIP * Position;\n"
+		"	color = Color;\n"
+		"	distance = Distance;\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"uniform float FALLOFF;\n"
+		"uniform float CUTOFF;\n"
+		"in vec4 color;\n"
+		"in float distance;\n"
+		"layout (location = 0) out vec4 fragColor;\n"
+		"layout (location = 1) out vec4 brightColor;\n"
+		"void main() {\n"
+		"	float denom = 1.0 + FALLOFF * distance;\n"
+		"	float strength = 1.0 / (denom * denom);\n"
+		"	if (strength < CUTOFF) discard;\n"
+		"	fragColor = vec4(color.rgb, color.a * strength);\n"
+		"	brightColor = fragColor;\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Position_vec4 = glGetAttribLocation(program, "Position");
+	Color_vec4 = glGetAttribLocation(program, "Color");
+	Distance_float = glGetAttribLocation(program, "Distance");
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+	FALLOFF_float = glGetUniformLocation(program, "FALLOFF");
+	CUTOFF_float = glGetUniformLocation(program, "CUTOFF");
+}
+
+BeamProgram::~BeamProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
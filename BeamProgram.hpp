@@ -0,0 +1,25 @@
+#pragma once
+
+#include "GL.hpp"
+#include "Load.hpp"
+
+//Shader program for laser beams (see DrawBeams): lines whose opacity falls off with distance from where the beam
+// was fired, 1 / (1 + FALLOFF * distance)^2, evaluated per fragment so a beam needs no subdivision to fade
+struct BeamProgram {
+	BeamProgram();
+	~BeamProgram();
+
+	GLuint program = 0;
+	//Attribute (per-vertex variable) locations:
+	GLuint Position_vec4 = -1U;
+	GLuint Color_vec4 = -1U;
+	GLuint Distance_float = -1U; //from where the beam was fired
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+	GLuint FALLOFF_float = -1U;
+	GLuint CUTOFF_float = -1U; //fragments fainter than this are dropped
+	//Textures:
+	// none
+};
+
+extern Load< BeamProgram > beam_program;
@@ -0,0 +1,66 @@
+#include "DrawBeams.hpp"
+#include "BeamProgram.hpp"
+#include "OrbitalMechanics.hpp"
+
+#include "gl_errors.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+//All DrawBeams instances share a vertex array object and vertex buffer, initialized at load time:
+
+//n.b. declared static so they don't conflict with similarly named global variables elsewhere:
+static GLuint vertex_buffer = 0;
+static GLuint vertex_buffer_for_beam_program = 0;
+
+static Load< void > setup_buffers(LoadTagDefault, [](){
+	glGenBuffers(1, &vertex_buffer);
+
+	glGenVertexArrays(1, &vertex_buffer_for_beam_program);
+	glBindVertexArray(vertex_buffer_for_beam_program);
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+
+	glVertexAttribPointer(beam_program->Position_vec4, 3, GL_FLOAT, GL_FALSE, sizeof(DrawBeams::Vertex),
+		(GLbyte *)0 + offsetof(DrawBeams::Vertex, Position));
+	glEnableVertexAttribArray(beam_program->Position_vec4);
+
+	glVertexAttribPointer(beam_program->Color_vec4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DrawBeams::Vertex),
+		(GLbyte *)0 + offsetof(DrawBeams::Vertex, Color));
+	glEnableVertexAttribArray(beam_program->Color_vec4);
+
+	glVertexAttribPointer(beam_program->Distance_float, 1, GL_FLOAT, GL_FALSE, sizeof(DrawBeams::Vertex),
+		(GLbyte *)0 + offsetof(DrawBeams::Vertex, Distance));
+	glEnableVertexAttribArray(beam_program->Distance_float);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	GL_ERRORS(); //PARANOIA: make sure nothing strange happened during setup
+});
+
+DrawBeams::DrawBeams(glm::mat4 const &world_to_clip_) : world_to_clip(world_to_clip_) {
+}
+
+void DrawBeams::draw(glm::vec3 const &a, glm::vec3 const &b, float a_distance, float b_distance,
+	glm::u8vec4 const &color) {
+	attribs.emplace_back(a, color, a_distance);
+	attribs.emplace_back(b, color, b_distance);
+}
+
+DrawBeams::~DrawBeams() {
+	if (attribs.empty()) return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+	glBufferData(GL_ARRAY_BUFFER, attribs.size() * sizeof(attribs[0]), attribs.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glUseProgram(beam_program->program);
+	glUniformMatrix4fv(beam_program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(world_to_clip));
+	glUniform1f(beam_program->FALLOFF_float, static_cast< float >(Beam::Falloff));
+	glUniform1f(beam_program->CUTOFF_float, static_cast< float >(Beam::MinVisibleStrength));
+
+	glBindVertexArray(vertex_buffer_for_beam_program);
+	glDrawArrays(GL_LINES, 0, GLsizei(attribs.size()));
+	glBindVertexArray(0);
+
+	glUseProgram(0);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+/*
+ * Helper class for immediate-mode drawing of laser beams, like DrawLines but with each line fading with distance
+ * from where its beam was fired (see BeamProgram), so a beam is one line however long it is.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+struct DrawBeams {
+	//Start drawing; will remember world_to_clip matrix:
+	DrawBeams(glm::mat4 const &world_to_clip);
+
+	//draw a beam from a to b (in world space), which are a_distance and b_distance from where it was fired:
+	void draw(glm::vec3 const &a, glm::vec3 const &b, float a_distance, float b_distance, glm::u8vec4 const &color);
+
+	//Finish drawing (push attribs to GPU):
+	~DrawBeams();
+
+	glm::mat4 world_to_clip;
+	struct Vertex {
+		Vertex(glm::vec3 const &Position_, glm::u8vec4 const &Color_, float Distance_)
+			: Position(Position_), Color(Color_), Distance(Distance_) { }
+		glm::vec3 Position;
+		glm::u8vec4 Color;
+		float Distance;
+	};
+	std::vector< Vertex > attribs;
+};
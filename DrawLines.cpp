@@ -6,18 +6,33 @@
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <cstring>
+
 //All DrawLines instances share a vertex array object and vertex buffer, initialized at load time:
 
 //n.b. declared static so they don't conflict with similarly named global variables elsewhere:
 static GLuint vertex_buffer = 0;
 static GLuint vertex_buffer_for_color_program = 0;
 
+//vertex_buffer is used as a ring: each DrawLines appends its vertices after the previous one's with an
+// unsynchronized map (the GPU never reads the part being written), and when the ring fills up it is invalidated
+// (orphaned, so the driver swaps in fresh storage without waiting) and refilled from the start.
+static GLsizeiptr constexpr InitialRingCapacity = 1 << 20; //bytes, grows if a single DrawLines needs more
+static GLsizeiptr ring_capacity = 0;
+static GLsizeiptr ring_head = 0; //where the next DrawLines' vertices go, bytes
+
+//vertex storage handed from each DrawLines to the next, so its capacity is reused rather than regrown every frame:
+static std::vector< DrawLines::Vertex > spare_attribs;
+
 static Load< void > setup_buffers(LoadTagDefault, [](){
 	//you may recognize this init code from DrawSprites.cpp:
 
 	{ //set up vertex buffer:
 		glGenBuffers(1, &vertex_buffer);
-		//for now, buffer will be un-filled.
+		ring_capacity = InitialRingCapacity;
+		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+		glBufferData(GL_ARRAY_BUFFER, ring_capacity, nullptr, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	{ //vertex array mapping buffer for color_program:
@@ -64,6 +79,7 @@ static Load< void > setup_buffers(LoadTagDefault, [](){
 
 
 DrawLines::DrawLines(glm::mat4 const &world_to_clip_) : world_to_clip(world_to_clip_) {
+	attribs.swap(spare_attribs);
 }
 
 void DrawLines::draw(glm::vec3 const &a, glm::vec3 const &b, glm::u8vec4 const &color) {
@@ -133,13 +149,34 @@ void DrawLines::draw_text(std::string const &text, glm::vec3 const &anchor_in, g
 }
 
 DrawLines::~DrawLines() {
-	if (attribs.empty()) return;
+	if (attribs.empty()) {
+		if (attribs.capacity() > spare_attribs.capacity()) attribs.swap(spare_attribs);
+		return;
+	}
 
 	//based on DrawSprites.cpp :
 
-	//upload vertices to vertex_buffer:
+	//upload vertices to the next free part of vertex_buffer:
 	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer); //set vertex_buffer as current
-	glBufferData(GL_ARRAY_BUFFER, attribs.size() * sizeof(attribs[0]), attribs.data(), GL_STREAM_DRAW); //upload attribs array
+	GLsizeiptr size = GLsizeiptr(attribs.size() * sizeof(attribs[0]));
+	GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+	if (size > ring_capacity) { //too big for the ring, so reallocate it (rarely)
+		while (ring_capacity < size) ring_capacity *= 2;
+		glBufferData(GL_ARRAY_BUFFER, ring_capacity, nullptr, GL_STREAM_DRAW);
+		ring_head = 0;
+	} else if (ring_head + size > ring_capacity) { //wrap around
+		access |= GL_MAP_INVALIDATE_BUFFER_BIT;
+		ring_head = 0;
+	}
+	void *mapped = glMapBufferRange(GL_ARRAY_BUFFER, ring_head, size, access);
+	if (mapped != nullptr) {
+		std::memcpy(mapped, attribs.data(), size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	} else { //mapping can fail (e.g. if the driver is short on address space), but the buffer is still writable
+		glBufferSubData(GL_ARRAY_BUFFER, ring_head, size, attribs.data());
+	}
+	GLint first = GLint(ring_head / GLsizeiptr(sizeof(attribs[0])));
+	ring_head += size;
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	//set color_program as current program:
@@ -152,13 +189,17 @@ DrawLines::~DrawLines() {
 	glBindVertexArray(vertex_buffer_for_color_program);
 
 	//run the OpenGL pipeline:
-	glDrawArrays(GL_LINES, 0, GLsizei(attribs.size()));
+	glDrawArrays(GL_LINES, first, GLsizei(attribs.size()));
 
 	//reset vertex array to none:
 	glBindVertexArray(0);
 
 	//reset current program to none:
 	glUseProgram(0);
+
+	//pass the storage on to the next DrawLines:
+	attribs.clear();
+	if (attribs.capacity() > spare_attribs.capacity()) attribs.swap(spare_attribs);
 }
 
 
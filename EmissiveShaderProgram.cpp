@@ -1,5 +1,6 @@
 #include "EmissiveShaderProgram.hpp"
 
+#include "UniformBlocks.hpp"
 #include "gl_compile_program.hpp"
 #include "gl_errors.hpp"
 
@@ -13,7 +14,8 @@ Load< EmissiveShaderProgram > emissive_program(LoadTagEarly, []() -> EmissiveSha
 	//----- build the pipeline template -----
 	emissive_program_pipeline.program = ret->program;
 
-	emissive_program_pipeline.OBJECT_TO_CLIP_mat4 = ret->OBJECT_TO_CLIP_mat4;
+	//transforms come from the Object uniform block:
+	emissive_program_pipeline.object_uniforms = true;
 
 	return ret;
 });
@@ -24,7 +26,7 @@ EmissiveShaderProgram::EmissiveShaderProgram() {
 	program = gl_compile_program(
 		//vertex shader:
 		"#version 330\n"
-		"uniform mat4 OBJECT_TO_CLIP;\n"
+		OBJECT_UNIFORMS_GLSL
 		"uniform vec4 Color;\n"
 		"in vec4 Position;\n"
 		"out vec4 color;\n"
@@ -49,8 +51,10 @@ EmissiveShaderProgram::EmissiveShaderProgram() {
 	//look up the locations of vertex attributes:
 	Position_vec4 = glGetAttribLocation(program, "Position");
 
+	//transforms come from a uniform block:
+	connect_uniform_blocks(program);
+
 	//look up the locations of uniforms:
-	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
 	COLOR_vec4 = glGetUniformLocation(program, "Color");
 
 }
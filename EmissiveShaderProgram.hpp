@@ -14,8 +14,9 @@ struct EmissiveShaderProgram {
 	GLuint Position_vec4 = -1U;
 	GLuint TexCoord_vec2 = -1U;
 	//Uniform (per-invocation variable) locations:
-	GLuint OBJECT_TO_CLIP_mat4 = -1U;
 	GLuint COLOR_vec4 = -1U;
+	//Uniform blocks (see UniformBlocks.hpp):
+	// Object - transforms, set by Scene::draw
 	//Textures:
 	//TEXTURE0 - texture that is accessed by TexCoord
 };
@@ -0,0 +1,78 @@
+#include "Ephemeris.hpp"
+#include "OrbitalMechanics.hpp"
+
+#include <cassert>
+#include <cmath>
+
+//Windows doesn't have M_PI apparently
+#ifndef M_PI // but other OS's do
+#define M_PI 3.14159265358979323846264
+#endif
+
+void Ephemeris::build(Orbit const &orbit) {
+	assert(orbit.p > 0.0 && orbit.c < MaxEccentricity);
+
+	//Chebyshev interpolation at the Chebyshev nodes of each segment: https://en.wikipedia.org/wiki/Chebyshev_nodes
+	//NOTE: state is a smooth periodic function of mean anomaly, so this converges quickly for planet-like orbits
+	coeffs.assign(Segments * Channels * Degree, 0.0);
+
+	double const span = 2.0 * M_PI / static_cast< double >(Segments);
+	double samples[Channels][Degree];
+	for (size_t s = 0; s < Segments; s++) {
+		double mid = -M_PI + (static_cast< double >(s) + 0.5) * span;
+		for (size_t j = 0; j < Degree; j++) {
+			double node = std::cos(M_PI * (static_cast< double >(j) + 0.5) / static_cast< double >(Degree));
+			double theta = orbit.mean_to_true(mid + 0.5 * span * node);
+			glm::dvec3 rpos = orbit.get_rpos(theta, orbit.compute_r(theta));
+			glm::dvec3 rvel = orbit.get_rvel(theta);
+			samples[0][j] = rpos.x;
+			samples[1][j] = rpos.y;
+			samples[2][j] = rvel.x;
+			samples[3][j] = rvel.y;
+		}
+
+		for (size_t ch = 0; ch < Channels; ch++) {
+			double *out = &coeffs[(s * Channels + ch) * Degree];
+			for (size_t k = 0; k < Degree; k++) {
+				double sum = 0.0;
+				for (size_t j = 0; j < Degree; j++) {
+					sum += samples[ch][j] * std::cos(M_PI * static_cast< double >(k) * (static_cast< double >(j) + 0.5)
+						/ static_cast< double >(Degree));
+				}
+				out[k] = 2.0 * sum / static_cast< double >(Degree);
+			}
+			out[0] *= 0.5;
+		}
+	}
+}
+
+void Ephemeris::clear() {
+	coeffs.clear();
+}
+
+void Ephemeris::eval(double M, glm::dvec3 &rpos, glm::dvec3 &rvel) const {
+	assert(valid());
+
+	//locate segment, and the position within it on [-1, 1]:
+	double const span = 2.0 * M_PI / static_cast< double >(Segments);
+	double u = (M + M_PI) / span;
+	u -= std::floor(u / static_cast< double >(Segments)) * static_cast< double >(Segments);
+	size_t s = std::min(static_cast< size_t >(u), Segments - 1);
+	double x = 2.0 * (u - static_cast< double >(s)) - 1.0;
+
+	//Clenshaw recurrence: https://en.wikipedia.org/wiki/Clenshaw_algorithm
+	double result[Channels];
+	for (size_t ch = 0; ch < Channels; ch++) {
+		double const *in = &coeffs[(s * Channels + ch) * Degree];
+		double b1 = 0.0, b2 = 0.0;
+		for (size_t k = Degree - 1; k > 0; k--) {
+			double b0 = 2.0 * x * b1 - b2 + in[k];
+			b2 = b1;
+			b1 = b0;
+		}
+		result[ch] = x * b1 - b2 + in[0];
+	}
+
+	rpos = glm::dvec3(result[0], result[1], 0.0);
+	rvel = glm::dvec3(result[2], result[3], 0.0);
+}
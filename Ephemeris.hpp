@@ -0,0 +1,36 @@
+#pragma once
+
+/*
+ * Piecewise Chebyshev ephemeris for a body on a fixed elliptic orbit.
+ *
+ * The relative state (to the orbit's origin) is fitted once over a full revolution, keyed on mean anomaly. Mean
+ * anomaly advances linearly with time, so looking up a body at any time ahead is a segment index and a short Clenshaw
+ * recurrence, instead of a Kepler solve per body (or stepping the whole system forward) for every query.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+struct Orbit;
+
+struct Ephemeris {
+	static size_t constexpr Segments = 32; //equal spans of mean anomaly per revolution
+	static size_t constexpr Degree = 12; //Chebyshev coefficients per segment, per channel
+	//fits lose accuracy as periapsis sharpens, so only orbits below this are fitted (~1e-6 relative error at the limit)
+	static double constexpr MaxEccentricity = 0.8;
+
+	//fit the given orbit (elliptic, c < MaxEccentricity), replacing any previous fit:
+	void build(Orbit const &orbit);
+	void clear();
+	bool valid() const { return !coeffs.empty(); }
+
+	//position and velocity relative to the orbit's origin at mean anomaly M (not required to be wrapped):
+	void eval(double M, glm::dvec3 &rpos, glm::dvec3 &rvel) const;
+
+	//-- internals --
+	//channels stored per segment are rpos.x, rpos.y, rvel.x, rvel.y (orbits are planar)
+	static size_t constexpr Channels = 4;
+	std::vector< double > coeffs; //[segment][channel][degree]
+};
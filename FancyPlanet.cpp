@@ -1,5 +1,6 @@
 #include "FancyPlanet.hpp"
 #include "GL.hpp"
+#include <algorithm>
 #include <set>
 #include <string>
 #include "glm/gtc/type_ptr.hpp"
@@ -13,7 +14,8 @@ struct LoadData {
     MeshBuffer buffer;
     GLuint vao;
     int count;
-    LoadData(MeshBuffer buffer, GLuint vao, int count) : buffer(buffer), vao(vao), count(count) {}
+    glm::vec4 bounds; //bounding sphere, in planet space
+    LoadData(MeshBuffer buffer, GLuint vao, int count, glm::vec4 bounds) : buffer(buffer), vao(vao), count(count), bounds(bounds) {}
 };
 
 Load<LoadData> planet_data(LoadTagDefault, []() ->  LoadData const * {
@@ -21,7 +23,8 @@ Load<LoadData> planet_data(LoadTagDefault, []() ->  LoadData const * {
 	//create a new vertex array object:
 	GLuint vao = buffer.make_vao_for_program(textured_planet_program->program);
 
-    LoadData const *data = new LoadData(buffer, vao, buffer.lookup("Planet").count);
+    Mesh const &mesh = buffer.lookup("Planet");
+    LoadData const *data = new LoadData(buffer, vao, mesh.count, mesh_bounding_sphere(mesh));
 	return data;
 });
 
@@ -30,15 +33,23 @@ FancyPlanet::FancyPlanet(Scene::Transform *_transform){
 
 }
 
-void FancyPlanet::draw(Scene::Camera *cam){
-    glUseProgram(textured_planet_program->program);
+void FancyPlanet::draw(Frustum const &frustum){
+    glm::mat4x3 object_to_world = transform->make_local_to_world();
 
-	glm::mat4 world_to_clip = cam->make_projection() * glm::mat4(cam->transform->make_world_to_local());
+    //skip planets entirely out of view:
+    glm::vec4 const &bounds = planet_data->bounds;
+    if (bounds.w >= 0.0f) {
+        glm::vec3 center = object_to_world * glm::vec4(glm::vec3(bounds), 1.0f);
+        float scale = std::max(glm::length(object_to_world[0]), std::max(glm::length(object_to_world[1]), glm::length(object_to_world[2])));
+        if (!frustum.sphere_visible(center, bounds.w * scale)) return;
+    }
 
-    glm::mat4x3 object_to_world = transform->make_local_to_world();
+    glUseProgram(textured_planet_program->program);
 
-    glm::mat4 object_to_clip = world_to_clip * glm::mat4(object_to_world);
-    glUniformMatrix4fv(textured_planet_program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(object_to_clip));
+    //the camera comes from the Frame uniform block, so only the planet's own transform is set here:
+    glUniformMatrix4x3fv(textured_planet_program->OBJECT_TO_LIGHT_mat4x3, 1, GL_FALSE, glm::value_ptr(object_to_world));
+    glm::mat3 normal_to_world = glm::inverse(glm::transpose(glm::mat3(object_to_world)));
+    glUniformMatrix3fv(textured_planet_program->NORMAL_TO_LIGHT_mat3, 1, GL_FALSE, glm::value_ptr(normal_to_world));
 
     glBindVertexArray(planet_data->vao);
     glDrawArrays(GL_TRIANGLES, 0, planet_data->count);
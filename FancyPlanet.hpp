@@ -1,9 +1,10 @@
 #include "GL.hpp"
 #include "Scene.hpp"
+#include "Frustum.hpp"
 
 struct FancyPlanet {
     FancyPlanet(Scene::Transform *transform);
-    void draw(Scene::Camera *cam);
+    void draw(Frustum const &frustum); //with the camera and lighting last given to set_frame_uniforms(), if in frustum
 
     GLuint texture, vao, vbo;
     Scene::Transform *transform;
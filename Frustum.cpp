@@ -0,0 +1,70 @@
+#include "Frustum.hpp"
+
+#include <cmath>
+
+Frustum::Frustum(glm::mat4 const &world_to_clip) {
+	//a world point p is in view when -w <= x,y,z <= w in clip space; each of those inequalities is a plane in
+	// world space, built from the rows of world_to_clip (Gribb & Hartmann's method):
+	auto row = [&world_to_clip](int r) {
+		return glm::vec4(world_to_clip[0][r], world_to_clip[1][r], world_to_clip[2][r], world_to_clip[3][r]);
+	};
+	glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+	planes[0] = w + x; //left
+	planes[1] = w - x; //right
+	planes[2] = w + y; //bottom
+	planes[3] = w - y; //top
+	planes[4] = w + z; //near
+	planes[5] = w - z; //far
+
+	//normalize, so that plane distances are real distances and can be compared with radii:
+	for (glm::vec4 &plane : planes) {
+		float length = glm::length(glm::vec3(plane));
+		if (length > 1e-6f * std::abs(plane.w)) {
+			plane /= length;
+		} else {
+			plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		}
+	}
+}
+
+bool Frustum::sphere_visible(glm::vec3 const &center, float radius) const {
+	for (glm::vec4 const &plane : planes) {
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+	}
+	return true;
+}
+
+bool Frustum::box_visible(glm::vec3 const &min, glm::vec3 const &max) const {
+	for (glm::vec4 const &plane : planes) {
+		//the corner of the box furthest along the plane's normal:
+		glm::vec3 corner(
+			plane.x >= 0.0f ? max.x : min.x,
+			plane.y >= 0.0f ? max.y : min.y,
+			plane.z >= 0.0f ? max.z : min.z
+		);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) return false;
+	}
+	return true;
+}
+
+void Frustum::spheres_visible(size_t count, float const *x, float const *y, float const *z, float const *radius,
+	uint8_t *visible) const {
+	for (size_t i = 0; i < count; ++i) {
+		visible[i] = 1;
+	}
+	//one plane at a time over every sphere, so the inner loop is straight-line arithmetic on contiguous arrays:
+	for (glm::vec4 const &plane : planes) {
+		float const a = plane.x, b = plane.y, c = plane.z, d = plane.w;
+		for (size_t i = 0; i < count; ++i) {
+			visible[i] &= uint8_t(a * x[i] + b * y[i] + c * z[i] + d >= -radius[i]);
+		}
+	}
+}
+
+glm::vec4 mesh_bounding_sphere(Mesh const &mesh) {
+	if (!(mesh.min.x <= mesh.max.x && mesh.min.y <= mesh.max.y && mesh.min.z <= mesh.max.z)) {
+		return glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+	}
+	glm::vec3 center = 0.5f * (mesh.min + mesh.max);
+	return glm::vec4(center, glm::length(mesh.max - center));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+/*
+ * A view frustum, as the six planes bounding a world-to-clip transform's view volume, for skipping things that
+ * can't be seen before they are sent to OpenGL.
+ *
+ * Tests are conservative: anything reported outside is definitely outside, but some things just beyond a corner
+ * of the frustum will be reported inside.
+ *
+ */
+
+#include "Mesh.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+struct Frustum {
+	//extract the planes from a world-to-clip matrix:
+	Frustum(glm::mat4 const &world_to_clip);
+
+	//is any part of the sphere / box inside?
+	bool sphere_visible(glm::vec3 const &center, float radius) const;
+	bool box_visible(glm::vec3 const &min, glm::vec3 const &max) const;
+
+	//test count spheres at once, given as parallel arrays (so the loop over them vectorizes);
+	// sets visible[i] to 1 if sphere i may be in view and 0 otherwise:
+	void spheres_visible(size_t count, float const *x, float const *y, float const *z, float const *radius,
+		uint8_t *visible) const;
+
+	//planes as (normal, offset), normals pointing inward, so a point p is inside when dot(normal, p) + offset >= 0;
+	// order is left, right, bottom, top, near, far. An infinite projection's far plane is degenerate, and is
+	// stored as (0,0,0,1) so that it passes everything:
+	enum : uint32_t { PlaneCount = 6 };
+	glm::vec4 planes[PlaneCount];
+};
+
+//sphere (xyz center, w radius) enclosing a mesh's bounding box, in the mesh's local space;
+// radius is negative if the mesh has no bounds:
+glm::vec4 mesh_bounding_sphere(Mesh const &mesh);
@@ -0,0 +1,65 @@
+#include "LitColorInstancedProgram.hpp"
+
+#include "UniformBlocks.hpp"
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+Load< LitColorInstancedProgram > lit_color_instanced_program(LoadTagEarly);
+
+LitColorInstancedProgram::LitColorInstancedProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		FRAME_UNIFORMS_GLSL
+		"in vec4 Position;\n"
+		"in vec3 Normal;\n"
+		"in vec4 Color;\n"
+		"in vec4 InstancePositionScale;\n"
+		"in vec4 InstanceColor;\n"
+		"in float InstanceSpin;\n"
+		"out vec3 position;\n"
+		"out vec3 normal;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		"	float c = cos(InstanceSpin);\n"
+		"	float s = sin(InstanceSpin);\n"
+		"	mat3 spin = mat3(c, s, 0.0, -s, c, 0.0, 0.0, 0.0, 1.0);\n"
+		"	position = spin * (InstancePositionScale.w * Position.xyz) + InstancePositionScale.xyz;\n"
+		"	gl_Position = WORLD_TO_CLIP * vec4(position, 1.0);\n"
+		"	normal = spin * Normal;\n" //scale is uniform, so normals only need the rotation
+		"	color = Color * InstanceColor;\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		FRAME_UNIFORMS_GLSL
+		"in vec3 position;\n"
+		"in vec3 normal;\n"
+		"in vec4 color;\n"
+		"layout (location = 0) out vec4 fragColor;\n"
+		"layout (location = 1) out vec4 brightColor;\n"
+		"void main() {\n"
+		"	vec3 n = normalize(normal);\n"
+		"	vec3 l = normalize(LIGHT_LOCATION - position);\n"
+		"	vec3 e = max(0.0, dot(n, l)) * LIGHT_ENERGY;\n"
+		"	fragColor = vec4((AMBIENT_COLOR * color.rgb) + e * color.rgb, color.a);\n"
+		"	brightColor = vec4(vec3(0.0), 1.0);\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Position_vec4 = glGetAttribLocation(program, "Position");
+	Normal_vec3 = glGetAttribLocation(program, "Normal");
+	Color_vec4 = glGetAttribLocation(program, "Color");
+	InstancePositionScale_vec4 = glGetAttribLocation(program, "InstancePositionScale");
+	InstanceColor_vec4 = glGetAttribLocation(program, "InstanceColor");
+	InstanceSpin_float = glGetAttribLocation(program, "InstanceSpin");
+
+	//camera and lighting come from a uniform block:
+	connect_uniform_blocks(program);
+}
+
+LitColorInstancedProgram::~LitColorInstancedProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
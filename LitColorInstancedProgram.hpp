@@ -0,0 +1,28 @@
+#pragma once
+
+#include "GL.hpp"
+#include "Load.hpp"
+
+//Shader program that draws many lit, vertex-colored copies of a mesh at once (see MeshInstances):
+// each copy is scaled uniformly, spun about z, moved and tinted by its per-instance attributes
+struct LitColorInstancedProgram {
+	LitColorInstancedProgram();
+	~LitColorInstancedProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-vertex variable) locations:
+	GLuint Position_vec4 = -1U;
+	GLuint Normal_vec3 = -1U;
+	GLuint Color_vec4 = -1U;
+
+	//Attribute (per-instance variable) locations:
+	GLuint InstancePositionScale_vec4 = -1U; //world position in xyz, scale in w
+	GLuint InstanceColor_vec4 = -1U; //multiplies the vertex color
+	GLuint InstanceSpin_float = -1U; //rotation about z, radians
+
+	//Uniform blocks (see UniformBlocks.hpp):
+	// Frame - WORLD_TO_CLIP and lighting (same meaning as in LitColorTextureProgram)
+};
+
+extern Load< LitColorInstancedProgram > lit_color_instanced_program;
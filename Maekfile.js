@@ -135,14 +135,34 @@ if (maek.OS === 'windows') {
 // cppFile: name of c++ file to compile
 // objFileBase (optional): base name object file to produce (if not supplied, set to options.objDir + '/' + cppFile without the extension)
 //returns objFile: objFileBase + a platform-dependant suffix ('.o' or '.obj')
+//orbital simulation, free of SDL/GL/audio so it can also be linked into headless tools:
+const orbit_names = [
+  maek.CPP('OrbitalMechanics.cpp'),
+  maek.CPP('OrbitBatch.cpp'),
+  maek.CPP('NBodyBatch.cpp'),
+  maek.CPP('SpatialHash.cpp'),
+  maek.CPP('Ephemeris.cpp'),
+  maek.CPP('Predictor.cpp')
+];
+
 const game_names = [
   maek.CPP('HUD.cpp'),
-  maek.CPP('OrbitalMechanics.cpp'),
+  maek.CPP('OrbitalMechanicsDraw.cpp'),
   maek.CPP('GP22IntroMode.cpp'),
   maek.CPP('PlayMode.cpp'),
   maek.CPP('MenuMode.cpp'),
   maek.CPP('main.cpp'),
   maek.CPP('LitColorTextureProgram.cpp'),
+  maek.CPP('LitColorInstancedProgram.cpp'),
+  maek.CPP('MeshInstances.cpp'),
+  maek.CPP('ThrustParticleProgram.cpp'),
+  maek.CPP('ThrustParticles.cpp'),
+  maek.CPP('OrbitLines.cpp'),
+  maek.CPP('OrbitLineProgram.cpp'),
+  maek.CPP('OrbitConics.cpp'),
+  maek.CPP('OrbitConicProgram.cpp'),
+  maek.CPP('DrawBeams.cpp'),
+  maek.CPP('BeamProgram.cpp'),
   maek.CPP('FrameQuadProgram.cpp'),
   maek.CPP('BloomBlurProgram.cpp'),
   maek.CPP('ColorTextureProgram.cpp'),
@@ -163,6 +183,8 @@ const common_names = [
   maek.CPP('DrawLines.cpp'),
   maek.CPP('ColorProgram.cpp'),
   maek.CPP('Scene.cpp'),
+  maek.CPP('UniformBlocks.cpp'),
+  maek.CPP('Frustum.cpp'),
   maek.CPP('Mesh.cpp'),
   maek.CPP('load_save_png.cpp'),
   maek.CPP('gl_compile_program.cpp'),
@@ -187,18 +209,24 @@ const freetype_test_names = [
   maek.CPP('freetype-test.cpp')
 ];
 
+//the '[libFile =] LIB(objFiles, libFileBase [, options])' archives an array of objects into a static library:
+// objFiles: array of objects to archive
+// libFileBase: name of library file to produce
+//returns libFile: libFileBase + a platform-dependant suffix ('.a' or '.lib')
+const orbit_lib = maek.LIB(orbit_names, 'objs/liborbit');
+
 //the '[exeFile =] LINK(objFiles, exeFileBase, [, options])' links an array of objects into an executable:
 // objFiles: array of objects to link
 // exeFileBase: name of executable file to produce
 //returns exeFile: exeFileBase + a platform-dependant suffix (e.g., '.exe' on windows)
-const game_exe = maek.LINK([...game_names, ...common_names], 'dist/game');
+const game_exe = maek.LINK([...game_names, ...common_names, orbit_lib], 'dist/game');
 const show_meshes_exe = maek.LINK([...show_meshes_names, ...common_names], 'scenes/show-meshes');
 const show_scene_exe = maek.LINK([...show_scene_names, ...common_names], 'scenes/show-scene');
 
 const freetype_test_exe = maek.LINK([...freetype_test_names], 'freetype-test');
 
 //set the default target to the game (and copy the readme files):
-maek.TARGETS = [game_exe, show_meshes_exe, show_scene_exe, freetype_test_exe, ...copies];
+maek.TARGETS = [game_exe, orbit_lib, show_meshes_exe, show_scene_exe, freetype_test_exe, ...copies];
 
 //the '[targets =] RULE(targets, prerequisites[, recipe])' rule defines a Makefile-style task
 // targets: array of targets the task produces (can include both files and ':abstract targets')
@@ -273,22 +301,27 @@ function init_maek() {
     objPrefix: 'objs/', //prefix for object file paths (if not explicitly specified)
     objSuffix: (OS === 'windows' ? '.obj' : '.o'), //suffix for object files
     exeSuffix: (OS === 'windows' ? '.exe' : ''), //suffix for executable files
+    libSuffix: (OS === 'windows' ? '.lib' : '.a'), //suffix for static library files
     depends: [], //extra dependencies; generally only set locally
     CPP: [], //the c++ compiler and any flags to start with (set below, per-OS)
     CPPFlags: [], //extra flags for c++ compiler
     LINK: [], //the linker and any flags to start with (set below, per-OS)
     LINKLibs: [], //extra -L and -l flags for linker
+    LIB: [], //the static library archiver and any flags to start with (set below, per-OS)
   }
 
   if (OS === 'windows') {
     DEFAULT_OPTIONS.CPP = ['cl.exe', '/nologo', '/EHsc', '/Z7', '/std:c++17', '/W4', '/WX', '/MD'];
     DEFAULT_OPTIONS.LINK = ['link.exe', '/nologo', '/SUBSYSTEM:CONSOLE', '/DEBUG:FASTLINK', '/INCREMENTAL:NO'];
+    DEFAULT_OPTIONS.LIB = ['lib.exe', '/nologo'];
   } else if (OS === 'linux') {
     DEFAULT_OPTIONS.CPP = ['g++', '-std=c++17', '-Wall', '-Werror', '-g'];
     DEFAULT_OPTIONS.LINK = ['g++', '-std=c++17', '-Wall', '-Werror', '-g'];
+    DEFAULT_OPTIONS.LIB = ['ar', 'rcs'];
   } else if (OS === 'macos') {
     DEFAULT_OPTIONS.CPP = ['clang++', '-std=c++17', '-Wall', '-Werror', '-Wshadow', '-g'];
     DEFAULT_OPTIONS.LINK = ['clang++', '-std=c++17', '-Wall', '-Werror', '-Wshadow', '-g'];
+    DEFAULT_OPTIONS.LIB = ['ar', 'rcs'];
   }
 
   //any settings here override 'DEFAULT_OPTIONS':
@@ -583,6 +616,48 @@ function init_maek() {
     return exeFile;
   };
 
+  //maek.LIB archives a static library from a collection of object files:
+  // objFiles is an array of object file names
+  // libFileBase is the base name of the library file ('.lib' or '.a' will be added)
+  maek.LIB = (objFiles, libFileBase, localOptions = {}) => {
+    const options = combineOptions(localOptions);
+
+    const libFile = libFileBase + options.libSuffix;
+
+    let libCommand;
+    if (OS === 'windows') {
+      libCommand = [...options.LIB, `/out:${libFile}`, ...objFiles];
+    } else {
+      libCommand = [...options.LIB, libFile, ...objFiles];
+    }
+    const depends = [...objFiles, ...options.depends];
+
+    const task = async () => {
+      //first, wait for all requested object files to build:
+      await updateTargets(depends, `${task.label}`);
+
+      //then archive (from scratch, since 'ar' would otherwise keep members that are no longer listed):
+      delete hashCache[libFile];
+      await fsPromises.mkdir(path.dirname(libFile), { recursive: true });
+      await fsPromises.rm(libFile, { force: true });
+      await runCommand(libCommand, `${task.label}: archive`);
+    };
+
+    task.keyFn = async () => {
+      await updateTargets(depends, `${task.label} (keyFn)`);
+      return [
+        libCommand,
+        ...(await hashFiles([await findExe(libCommand), libFile, ...depends]))
+      ];
+    };
+
+    task.label = `LIB ${libFile}`;
+
+    maek.tasks[libFile] = task;
+
+    return libFile;
+  };
+
   //---------------------------------
   //helper functions used by the build rules:
 
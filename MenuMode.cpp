@@ -2,6 +2,7 @@
 #include "EmissiveShaderProgram.hpp"
 #include "GL.hpp"
 #include "LitColorTextureProgram.hpp"
+#include "UniformBlocks.hpp"
 #include "Utils.hpp"
 
 #include "DrawLines.hpp"
@@ -245,7 +246,13 @@ void MenuMode::draw(glm::uvec2 const &drawable_size)
 	}
 
 	{
-		skybox.draw(camera);
+		FrameUniforms frame;
+		frame.WORLD_TO_VIEW = glm::mat4(camera->transform->make_world_to_local());
+		frame.PROJECTION = camera->make_projection();
+		frame.WORLD_TO_CLIP = frame.PROJECTION * frame.WORLD_TO_VIEW;
+		set_frame_uniforms(frame);
+
+		skybox.draw();
 	}
 
 	GL_ERRORS();
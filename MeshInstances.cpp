@@ -0,0 +1,84 @@
+#include "MeshInstances.hpp"
+#include "LitColorInstancedProgram.hpp"
+
+#include "gl_errors.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+MeshInstances::MeshInstances(MeshBuffer const &meshes, Mesh const &mesh_) : mesh(mesh_) {
+	glm::vec4 sphere = mesh_bounding_sphere(mesh);
+	radius = (sphere.w < 0.0f ? std::numeric_limits< float >::infinity() : glm::length(glm::vec3(sphere)) + sphere.w);
+
+	glGenBuffers(1, &instance_buffer);
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	//per-vertex attributes come from the mesh buffer:
+	glBindBuffer(GL_ARRAY_BUFFER, meshes.buffer);
+	auto bind_vertex = [&](GLuint location, MeshBuffer::Attrib const &attrib) {
+		if (location == -1U || attrib.size == 0) return;
+		glVertexAttribPointer(location, attrib.size, attrib.type, attrib.normalized, attrib.stride, (GLbyte *)0 + attrib.offset);
+		glEnableVertexAttribArray(location);
+	};
+	bind_vertex(lit_color_instanced_program->Position_vec4, meshes.Position);
+	bind_vertex(lit_color_instanced_program->Normal_vec3, meshes.Normal);
+	bind_vertex(lit_color_instanced_program->Color_vec4, meshes.Color);
+
+	//..and per-instance ones from instance_buffer, advancing once per copy:
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	auto bind_instance = [&](GLuint location, GLint size, GLenum type, GLboolean normalized, size_t offset) {
+		if (location == -1U) return;
+		glVertexAttribPointer(location, size, type, normalized, sizeof(Instance), (GLbyte *)0 + offset);
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	};
+	bind_instance(lit_color_instanced_program->InstancePositionScale_vec4, 4, GL_FLOAT, GL_FALSE, offsetof(Instance, position_scale));
+	bind_instance(lit_color_instanced_program->InstanceColor_vec4, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Instance, color));
+	bind_instance(lit_color_instanced_program->InstanceSpin_float, 1, GL_FLOAT, GL_FALSE, offsetof(Instance, spin));
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	GL_ERRORS();
+}
+
+MeshInstances::~MeshInstances() {
+	glDeleteVertexArrays(1, &vao);
+	vao = 0;
+	glDeleteBuffers(1, &instance_buffer);
+	instance_buffer = 0;
+}
+
+void MeshInstances::cull(Frustum const &frustum) {
+	size_t kept = 0;
+	for (size_t i = 0; i < instances.size(); ++i) {
+		glm::vec4 const &position_scale = instances[i].position_scale;
+		if (!frustum.sphere_visible(glm::vec3(position_scale), position_scale.w * radius)) continue;
+		if (kept != i) instances[kept] = instances[i];
+		++kept;
+	}
+	instances.erase(instances.begin() + kept, instances.end());
+}
+
+void MeshInstances::draw() const {
+	if (instances.empty() || mesh.count == 0) return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	GLsizeiptr size = GLsizeiptr(instances.size() * sizeof(Instance));
+	//grow geometrically, so a rising count doesn't reallocate every frame:
+	if (size > instance_capacity) instance_capacity = std::max(size, 2 * instance_capacity);
+	//fresh storage (orphaning last frame's) rather than wait for the GPU to finish reading it:
+	glBufferData(GL_ARRAY_BUFFER, instance_capacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glUseProgram(lit_color_instanced_program->program);
+	glBindVertexArray(vao);
+	glDrawArraysInstanced(mesh.type, mesh.start, mesh.count, GLsizei(instances.size()));
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	GL_ERRORS();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * Draws every copy of one mesh with a single glDrawArraysInstanced call, instead of a Scene::Drawable (and a draw
+ * call, with its own uniforms) per copy. Copies are described by a per-instance attribute buffer which is refilled
+ * from 'instances' once per draw; see LitColorInstancedProgram for how they are placed and lit.
+ *
+ */
+
+#include "GL.hpp"
+#include "Mesh.hpp"
+#include "Frustum.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+struct MeshInstances {
+	MeshInstances(MeshBuffer const &meshes, Mesh const &mesh);
+	~MeshInstances();
+
+	//owns GL objects, so copying isn't meaningful:
+	MeshInstances(MeshInstances const &) = delete;
+	MeshInstances &operator=(MeshInstances const &) = delete;
+
+	struct Instance {
+		Instance(glm::vec3 const &position, float scale, float spin_, glm::u8vec4 const &color_ = glm::u8vec4(0xff))
+			: position_scale(position, scale), color(color_), spin(spin_) {}
+		glm::vec4 position_scale; //world position in xyz, uniform scale in w
+		glm::u8vec4 color; //tint
+		float spin; //rotation about z, radians
+	};
+	static_assert(sizeof(Instance) == 4*4 + 4 + 4, "Instance is packed.");
+
+	//filled by the caller, then drawn (and left alone) by draw():
+	std::vector< Instance > instances;
+
+	//drop any instances entirely outside frustum (after filling instances, before drawing them):
+	void cull(Frustum const &frustum);
+
+	//upload instances and draw them all, with the camera and lighting last given to set_frame_uniforms():
+	void draw() const;
+
+	//-- internals --
+	Mesh mesh;
+	float radius; //of a sphere around the mesh's origin (which copies are placed and spun about) enclosing it
+	GLuint vao = 0;
+	GLuint instance_buffer = 0;
+	mutable GLsizeiptr instance_capacity = 0; //bytes allocated for instance_buffer
+};
@@ -0,0 +1,182 @@
+#include "NBodyBatch.hpp"
+#include "OrbitalMechanics.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+std::array< std::vector< double > *, 4 > NBodyBatch::columns() {
+	return { &x, &y, &vx, &vy };
+}
+
+void NBodyBatch::add_source(Body const *body) {
+	assert(body != nullptr);
+	if (body->mass <= 0.0) return;
+
+	sources.emplace_back(body);
+	source_mu.emplace_back(Orbit::G * body->mass);
+	source_radius.emplace_back(body->radius);
+	source_x.emplace_back(body->pos.x);
+	source_y.emplace_back(body->pos.y);
+}
+
+NBodyBatch::Handle NBodyBatch::add(glm::dvec3 const &pos, glm::dvec3 const &vel) {
+	Handle handle;
+	if (!free_handles.empty()) {
+		handle = free_handles.back();
+		free_handles.pop_back();
+	} else {
+		handle = static_cast< Handle >(dense_of.size());
+		dense_of.emplace_back();
+	}
+	dense_of[handle] = static_cast< uint32_t >(size());
+	handle_of.emplace_back(handle);
+
+	x.emplace_back(pos.x);
+	y.emplace_back(pos.y);
+	vx.emplace_back(vel.x);
+	vy.emplace_back(vel.y);
+
+	return handle;
+}
+
+void NBodyBatch::remove(Handle handle) {
+	assert(handle < dense_of.size());
+	uint32_t i = dense_of[handle];
+	uint32_t last = static_cast< uint32_t >(size()) - 1;
+	assert(i <= last);
+
+	//move the last entry into the hole so the arrays stay dense
+	for (std::vector< double > *column : columns()) {
+		(*column)[i] = (*column)[last];
+		column->pop_back();
+	}
+	handle_of[i] = handle_of[last];
+	dense_of[handle_of[i]] = i;
+	handle_of.pop_back();
+
+	dense_of[handle] = ~uint32_t(0);
+	free_handles.emplace_back(handle);
+}
+
+void NBodyBatch::clear() {
+	for (std::vector< double > *column : columns()) {
+		column->clear();
+	}
+	dense_of.clear();
+	handle_of.clear();
+	free_handles.clear();
+
+	sources.clear();
+	source_mu.clear();
+	source_radius.clear();
+	source_x.clear();
+	source_y.clear();
+}
+
+void NBodyBatch::place_sources(double time) {
+	for (size_t s = 0; s < sources.size(); s++) {
+		//bodies only know their state relative to what they orbit, so walk up to the (fixed) root
+		glm::dvec3 pos(0.0);
+		Body const *body = sources[s];
+		while (body->orbit != nullptr) {
+			glm::dvec3 rpos, rvel;
+			body->state_at(time, rpos, rvel);
+			pos += rpos;
+			body = body->orbit->origin;
+		}
+		pos += body->pos;
+		source_x[s] = pos.x;
+		source_y[s] = pos.y;
+	}
+}
+
+void NBodyBatch::kick(std::vector< uint32_t > const &block, double scale) {
+	//one source at a time, so the inner loop is a straight run over the particles
+	for (size_t s = 0; s < sources.size(); s++) {
+		const double sx = source_x[s];
+		const double sy = source_y[s];
+		const double smu = scale * source_mu[s];
+		const double r_min2 = source_radius[s] * source_radius[s];
+		for (uint32_t i : block) {
+			double dx = sx - x[i];
+			double dy = sy - y[i];
+			double r2 = std::max(dx * dx + dy * dy, r_min2);
+			double f = smu / (r2 * std::sqrt(r2));
+			vx[i] += f * dx;
+			vy[i] += f * dy;
+		}
+	}
+}
+
+void NBodyBatch::integrate(std::vector< uint32_t > const &block, uint64_t count, double h, double start_time) {
+	//Yoshida's coefficients: leapfrog composed with steps of w1, w0, w1 so the 3rd order error terms cancel
+	const double cbrt2 = std::cbrt(2.0);
+	const double w1 = 1.0 / (2.0 - cbrt2);
+	const double w0 = -cbrt2 / (2.0 - cbrt2);
+	const std::array< double, 4 > drift = { 0.5 * w1, 0.5 * (w0 + w1), 0.5 * (w0 + w1), 0.5 * w1 };
+	const std::array< double, 3 > kicks = { w1, w0, w1 };
+
+	for (uint64_t step = 0; step < count; step++) {
+		const double t = start_time + static_cast< double >(step) * h; //(not accumulated, so long runs don't drift)
+		double local = 0.0; //time into this step, for placing the sources at each kick
+		for (size_t k = 0; k < 4; k++) {
+			const double dt = drift[k] * h;
+			for (uint32_t i : block) {
+				x[i] += dt * vx[i];
+				y[i] += dt * vy[i];
+			}
+			local += drift[k];
+			if (k == 3) break;
+
+			place_sources(t + local * h);
+			kick(block, kicks[k] * h);
+		}
+	}
+}
+
+void NBodyBatch::update(double elapsed, double start_time) {
+	const double time = dilated(elapsed);
+	const size_t n = size();
+	if (n == 0 || time <= 0.0) return;
+
+	//sort particles into blocks by how many steps each needs, from its tightest source pairing now:
+	for (std::vector< uint32_t > &block : blocks) {
+		block.clear();
+	}
+	place_sources(start_time);
+	for (size_t i = 0; i < n; i++) {
+		double fall2 = std::numeric_limits< double >::infinity(); //squared free-fall time
+		for (size_t s = 0; s < sources.size(); s++) {
+			const double r_min2 = source_radius[s] * source_radius[s];
+			double dx = source_x[s] - x[i];
+			double dy = source_y[s] - y[i];
+			double r2 = std::max(dx * dx + dy * dy, r_min2);
+			fall2 = std::min(fall2, r2 * std::sqrt(r2) / source_mu[s]);
+		}
+		double steps = std::ceil(time / (StepFraction * std::sqrt(fall2)));
+		//smallest level with 2^level >= steps:
+		size_t level = (steps > 1.0 ? static_cast< size_t >(std::ilogb(steps - 1.0)) + 1 : 0);
+		assert(level < 64 && "update too long to integrate; see StepFraction");
+		if (blocks.size() <= level) blocks.resize(level + 1);
+		blocks[level].emplace_back(static_cast< uint32_t >(i));
+	}
+
+	for (size_t level = 0; level < blocks.size(); level++) {
+		if (blocks[level].empty()) continue;
+		integrate(blocks[level], uint64_t(1) << level, std::ldexp(time, -static_cast< int >(level)), start_time);
+	}
+}
+
+glm::dvec3 NBodyBatch::get_pos(Handle handle) const {
+	assert(handle < dense_of.size());
+	uint32_t i = dense_of[handle];
+	return glm::dvec3(x[i], y[i], 0.0);
+}
+
+glm::dvec3 NBodyBatch::get_vel(Handle handle) const {
+	assert(handle < dense_of.size());
+	uint32_t i = dense_of[handle];
+	return glm::dvec3(vx[i], vy[i], 0.0);
+}
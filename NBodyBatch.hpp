@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+ * Structure-of-arrays integrator for massless particles (debris, pellets) under the gravity of every body at once,
+ * as an alternative to pinning them to a single conic (see OrbitBatch).
+ *
+ * Bodies stay on rails, so their field is just a handful of point masses looked up at each kick through
+ * Body::state_at; with so few sources direct summation is cheaper than any tree. Particles are advanced with
+ * Yoshida's 4th order symplectic composition of leapfrog (drift-kick-drift), which keeps orbits from spiralling
+ * in or out over long runs the way non-symplectic schemes do. Like OrbitBatch, entries are referenced through
+ * stable handles and removal swaps the last entry into the hole.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+struct Body;
+
+struct NBodyBatch {
+	typedef uint32_t Handle;
+	static Handle constexpr InvalidHandle = ~Handle(0);
+
+	//bodies whose gravity acts on the particles (massless ones are ignored):
+	void add_source(Body const *body);
+
+	//register a particle by its world-space state (orbits are planar, so z is dropped):
+	Handle add(glm::dvec3 const &pos, glm::dvec3 const &vel);
+	//stop integrating the particle behind handle (handle may be reused afterwards):
+	void remove(Handle handle);
+	void clear(); //drops particles and sources
+	size_t size() const { return x.size(); }
+
+	//advance every particle by elapsed (real) seconds, scaled by the current dilation (or rails step), starting
+	// from universal time start_time
+	void update(double elapsed, double start_time);
+
+	glm::dvec3 get_pos(Handle handle) const;
+	glm::dvec3 get_vel(Handle handle) const;
+
+	//Each particle steps at no more than StepFraction of its own shortest free-fall time sqrt(r^3 / mu) to any
+	// source, as of the start of the update; step counts are rounded up to powers of two ("block" steps) and
+	// particles sharing a count are integrated together, so a close encounter only slows down the particles in it.
+	//There is no cap on the step count: the whole update is always covered at that accuracy. (Very long updates,
+	// like on-rails warp, are better handed to conics instead; see PlayMode::tick.)
+	static double constexpr StepFraction = 0.05;
+
+	//-- internals --
+
+	//every per-entry array, so bookkeeping (add/remove/clear) can treat them uniformly:
+	std::array< std::vector< double > *, 4 > columns();
+
+	//source positions (world space) at universal time, into source_x/source_y:
+	void place_sources(double time);
+	//advance the particles at dense indices block by count steps of h, from universal time start_time:
+	void integrate(std::vector< uint32_t > const &block, uint64_t count, double h, double start_time);
+	//velocity += scale * acceleration at the current positions, for the particles at dense indices block:
+	void kick(std::vector< uint32_t > const &block, double scale);
+
+	//handle -> dense index, and dense index -> handle:
+	std::vector< uint32_t > dense_of;
+	std::vector< Handle > handle_of;
+	std::vector< Handle > free_handles;
+
+	//Sources:
+	std::vector< Body const * > sources;
+	std::vector< double > source_mu; //=G * mass
+	std::vector< double > source_radius; //field is softened inside, so particles passing through stay finite
+	std::vector< double > source_x, source_y; //scratch, positions at the time of the current kick
+
+	//scratch, dense indices of the particles taking 2^level steps this update, by level:
+	std::vector< std::vector< uint32_t > > blocks;
+
+	//State (dense), world frame:
+	std::vector< double > x, y;
+	std::vector< double > vx, vy;
+};
@@ -0,0 +1,145 @@
+#include "OrbitBatch.hpp"
+#include "OrbitalMechanics.hpp"
+
+#include <cassert>
+#include <cmath>
+
+//Windows doesn't have M_PI apparently
+#ifndef M_PI // but other OS's do
+#define M_PI 3.14159265358979323846264
+#endif
+
+std::array< std::vector< double > *, 15 > OrbitBatch::columns() {
+	return {
+		&c, &a, &b, &sqrt_mu_a, &mean_motion, &cos_phi, &sin_phi, &flip,
+		&M, &revs, &r, &x, &y, &vx, &vy
+	};
+}
+
+OrbitBatch::Handle OrbitBatch::add(Orbit const &orbit) {
+	//NOTE: only closed orbits repeat, which is what lets the kernel wrap the mean anomaly
+	assert(orbit.p > 0.0 && orbit.c < 1.0);
+
+	Handle handle;
+	if (!free_handles.empty()) {
+		handle = free_handles.back();
+		free_handles.pop_back();
+	} else {
+		handle = static_cast< Handle >(dense_of.size());
+		dense_of.emplace_back();
+	}
+	dense_of[handle] = static_cast< uint32_t >(size());
+	handle_of.emplace_back(handle);
+
+	double a_ = 1.0 / orbit.inv_a;
+	c.emplace_back(orbit.c);
+	a.emplace_back(a_);
+	b.emplace_back(a_ * std::sqrt(1.0 - orbit.c * orbit.c));
+	sqrt_mu_a.emplace_back(std::sqrt(orbit.mu * a_));
+	mean_motion.emplace_back(orbit.mean_motion);
+	cos_phi.emplace_back(std::cos(orbit.phi));
+	sin_phi.emplace_back(std::sin(orbit.phi));
+	flip.emplace_back(orbit.incl != 0.0 ? -1.0 : 1.0);
+
+	double revs_ = 2.0 * M_PI * std::round(orbit.theta / (2.0 * M_PI));
+	M.emplace_back(orbit.true_to_mean(orbit.theta - revs_));
+	revs.emplace_back(revs_);
+	r.emplace_back(orbit.r);
+	x.emplace_back(orbit.rpos.x);
+	y.emplace_back(orbit.rpos.y);
+	vx.emplace_back(orbit.rvel.x);
+	vy.emplace_back(orbit.rvel.y);
+
+	return handle;
+}
+
+void OrbitBatch::remove(Handle handle) {
+	assert(handle < dense_of.size());
+	uint32_t i = dense_of[handle];
+	uint32_t last = static_cast< uint32_t >(size()) - 1;
+	assert(i <= last);
+
+	//move the last entry into the hole so the arrays stay dense
+	for (std::vector< double > *column : columns()) {
+		(*column)[i] = (*column)[last];
+		column->pop_back();
+	}
+	handle_of[i] = handle_of[last];
+	dense_of[handle_of[i]] = i;
+	handle_of.pop_back();
+
+	dense_of[handle] = ~uint32_t(0);
+	free_handles.emplace_back(handle);
+}
+
+void OrbitBatch::clear() {
+	for (std::vector< double > *column : columns()) {
+		column->clear();
+	}
+	dense_of.clear();
+	handle_of.clear();
+	free_handles.clear();
+}
+
+void OrbitBatch::update(double elapsed) {
+	//Same closed-form propagation as Orbit::update, restricted to ellipses and written without data dependent
+	// branches so the compiler is free to vectorize across entries.
+	//Position/velocity come straight from the eccentric anomaly E, so no true anomaly is needed per frame:
+	// rpos = (a(cos E - c), b sin E), rvel = sqrt(mu a) / r * (-sin E, (b / a) cos E), in the orbital plane
+	const double time = dilated(elapsed);
+	const double two_pi = 2.0 * M_PI;
+	const size_t n = size();
+
+	for (size_t i = 0; i < n; i++) {
+		double Mi = M[i] + mean_motion[i] * time;
+		double wrap = two_pi * std::floor(Mi / two_pi + 0.5);
+		revs[i] += wrap;
+		Mi -= wrap;
+		M[i] = Mi;
+
+		//Kepler's equation: Danby's starting guess, then Halley's method
+		double e = c[i];
+		double E = Mi + 0.85 * e * (Mi >= 0.0 ? 1.0 : -1.0);
+		for (int k = 0; k < KeplerIterations; k++) {
+			double esin = e * std::sin(E);
+			double f = E - esin - Mi;
+			double df = 1.0 - e * std::cos(E);
+			E -= f / (df - 0.5 * f * esin / df);
+		}
+
+		double cosE = std::cos(E);
+		double sinE = std::sin(E);
+		double ri = a[i] * (1.0 - e * cosE);
+		double lx = a[i] * (cosE - e);
+		double ly = flip[i] * b[i] * sinE;
+		double s = sqrt_mu_a[i] / ri;
+		double lvx = -s * sinE;
+		double lvy = flip[i] * s * (b[i] / a[i]) * cosE;
+
+		r[i] = ri;
+		x[i] = cos_phi[i] * lx - sin_phi[i] * ly;
+		y[i] = sin_phi[i] * lx + cos_phi[i] * ly;
+		vx[i] = cos_phi[i] * lvx - sin_phi[i] * lvy;
+		vy[i] = sin_phi[i] * lvx + cos_phi[i] * lvy;
+	}
+}
+
+glm::dvec3 OrbitBatch::get_rpos(Handle handle) const {
+	uint32_t i = dense_of[handle];
+	return glm::dvec3(x[i], y[i], 0.0);
+}
+
+void OrbitBatch::read(Handle handle, Orbit &orbit) const {
+	assert(handle < dense_of.size());
+	uint32_t i = dense_of[handle];
+
+	orbit.rpos = glm::dvec3(x[i], y[i], 0.0);
+	orbit.rvel = glm::dvec3(vx[i], vy[i], 0.0);
+	orbit.r = r[i];
+
+	//true anomaly (only needed to keep the Orbit itself consistent for drawing/serialization):
+	double lx = cos_phi[i] * x[i] + sin_phi[i] * y[i];
+	double ly = flip[i] * (cos_phi[i] * y[i] - sin_phi[i] * x[i]);
+	orbit.theta = revs[i] + std::atan2(ly, lx);
+	orbit.compute_dtheta();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+/*
+ * Structure-of-arrays propagator for large numbers of entities on fixed elliptic conics (fuel pellets, debris).
+ *
+ * Elements are stored in contiguous arrays and advanced together by a single branch-free loop, so the per-entity
+ * cost is a handful of multiply-adds plus a fixed number of Kepler iterations instead of a pointer chase into a
+ * full Orbit. Entries are referenced through stable handles; removal swaps the last entry into the hole.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+struct Orbit;
+
+struct OrbitBatch {
+	typedef uint32_t Handle;
+	static Handle constexpr InvalidHandle = ~Handle(0);
+
+	//register an (elliptic) orbit, the batch takes over propagating it:
+	Handle add(Orbit const &orbit);
+	//stop propagating the orbit behind handle (handle may be reused afterwards):
+	void remove(Handle handle);
+	void clear();
+	size_t size() const { return c.size(); }
+
+	//advance every entry by elapsed (real) seconds, scaled by the current dilation (or rails step):
+	void update(double elapsed);
+
+	//copy the propagated state of an entry back into its Orbit (theta, r, dtheta, rpos, rvel):
+	void read(Handle handle, Orbit &orbit) const;
+	glm::dvec3 get_rpos(Handle handle) const;
+
+	//Number of Halley iterations taken by update(), fixed so the kernel has no data dependent branches
+	//NOTE: converges to double precision for eccentricities up to ~0.99 from Danby's starting guess
+	static int constexpr KeplerIterations = 6;
+
+	//-- internals --
+
+	//every per-entry array, so bookkeeping (add/remove/clear) can treat them uniformly:
+	std::array< std::vector< double > *, 15 > columns();
+
+	//handle -> dense index, and dense index -> handle:
+	std::vector< uint32_t > dense_of;
+	std::vector< Handle > handle_of;
+	std::vector< Handle > free_handles;
+
+	//Elements (dense):
+	std::vector< double > c; //eccentricity
+	std::vector< double > a; //semi-major axis
+	std::vector< double > b; //semi-minor axis
+	std::vector< double > sqrt_mu_a; //=sqrt(mu * a), scales orbital velocity
+	std::vector< double > mean_motion;
+	std::vector< double > cos_phi, sin_phi; //periapsis direction
+	std::vector< double > flip; //+1 prograde, -1 retrograde (inclination of 0 or pi)
+
+	//State (dense):
+	std::vector< double > M; //mean anomaly, wrapped to [-pi, pi]
+	std::vector< double > revs; //whole revolutions (multiple of 2 pi) split off from the mean anomaly
+	std::vector< double > r;
+	std::vector< double > x, y; //relative position, world frame (orbits are planar)
+	std::vector< double > vx, vy; //relative velocity, world frame
+};
@@ -0,0 +1,60 @@
+#include "OrbitConicProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+Load< OrbitConicProgram > orbit_conic_program(LoadTagEarly);
+
+OrbitConicProgram::OrbitConicProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 WORLD_TO_CLIP;\n"
+		"uniform int SEGMENTS;\n"
+		"in vec3 InstanceOrigin;\n"
+		"in vec4 InstanceConic;\n"
+		"in vec2 InstanceRange;\n"
+		"in vec4 InstanceColor;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		"	float t = float(gl_VertexID) / float(SEGMENTS);\n"
+		"	float theta = InstanceRange.x + t * InstanceRange.y;\n"
+		"	float r = InstanceConic.y / (1.0 + InstanceConic.x * cos(theta));\n"
+		"	vec2 plane = r * vec2(cos(theta), sin(theta));\n"
+		//orbital plane to world, as Orbit::rot does it: tilt by inclination about x, then turn by phi about z
+		"	float ci = cos(InstanceConic.w);\n"
+		"	float si = sin(InstanceConic.w);\n"
+		"	vec3 tilted = vec3(plane.x, plane.y * ci, plane.y * si);\n"
+		"	float cp = cos(InstanceConic.z);\n"
+		"	float sp = sin(InstanceConic.z);\n"
+		"	vec3 position = InstanceOrigin + vec3(cp * tilted.x - sp * tilted.y, sp * tilted.x + cp * tilted.y, tilted.z);\n"
+		"	gl_Position = WORLD_TO_CLIP * vec4(position, 1.0);\n"
+		"	color = vec4(InstanceColor.rgb, InstanceColor.a * max(0.2, 1.0 - t));\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"in vec4 color;\n"
+		"layout (location = 0) out vec4 fragColor;\n"
+		"layout (location = 1) out vec4 brightColor;\n"
+		"void main() {\n"
+		"	fragColor = color;\n"
+		"	brightColor = color;\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	InstanceOrigin_vec3 = glGetAttribLocation(program, "InstanceOrigin");
+	InstanceConic_vec4 = glGetAttribLocation(program, "InstanceConic");
+	InstanceRange_vec2 = glGetAttribLocation(program, "InstanceRange");
+	InstanceColor_vec4 = glGetAttribLocation(program, "InstanceColor");
+
+	//look up the locations of uniforms:
+	WORLD_TO_CLIP_mat4 = glGetUniformLocation(program, "WORLD_TO_CLIP");
+	SEGMENTS_int = glGetUniformLocation(program, "SEGMENTS");
+}
+
+OrbitConicProgram::~OrbitConicProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
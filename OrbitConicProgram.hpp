@@ -0,0 +1,29 @@
+#pragma once
+
+#include "GL.hpp"
+#include "Load.hpp"
+
+//Shader program that draws closed orbits straight from their elements (see OrbitConics): each instance is one
+// conic, and vertex i of its line strip lies at true anomaly InstanceRange.x + InstanceRange.y * i / SEGMENTS,
+// at distance r = p / (1 + c cos(theta)) from the focus, fading out along the strip
+struct OrbitConicProgram {
+	OrbitConicProgram();
+	~OrbitConicProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-instance variable) locations:
+	GLuint InstanceOrigin_vec3 = -1U; //world position of the focus
+	GLuint InstanceConic_vec4 = -1U; //eccentricity, semi-latus rectum, periapsis angle, inclination
+	GLuint InstanceRange_vec2 = -1U; //true anomaly the strip starts at, and how far it goes
+	GLuint InstanceColor_vec4 = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint WORLD_TO_CLIP_mat4 = -1U;
+	GLuint SEGMENTS_int = -1U; //lines per strip
+
+	//Textures:
+	// none
+};
+
+extern Load< OrbitConicProgram > orbit_conic_program;
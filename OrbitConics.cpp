@@ -0,0 +1,88 @@
+#include "OrbitConics.hpp"
+#include "OrbitConicProgram.hpp"
+#include "OrbitalMechanics.hpp"
+
+#include "gl_errors.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+//Windows doesn't have M_PI apparently
+#ifndef M_PI // but other OS's do
+#define M_PI 3.14159265358979323846264
+#endif
+
+//All OrbitConics instances share a vertex array object and instance buffer, initialized at load time:
+
+//n.b. declared static so they don't conflict with similarly named global variables elsewhere:
+static GLuint instance_buffer = 0;
+static GLsizeiptr instance_capacity = 0; //bytes allocated for instance_buffer
+static GLuint instance_buffer_for_orbit_conic_program = 0;
+
+static Load< void > setup_buffers(LoadTagDefault, [](){
+	glGenBuffers(1, &instance_buffer);
+
+	//there are no per-vertex attributes: vertices are placed from gl_VertexID alone
+	glGenVertexArrays(1, &instance_buffer_for_orbit_conic_program);
+	glBindVertexArray(instance_buffer_for_orbit_conic_program);
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+
+	auto bind_instance = [](GLuint location, GLint size, GLenum type, GLboolean normalized, size_t offset) {
+		glVertexAttribPointer(location, size, type, normalized, sizeof(OrbitConics::Instance), (GLbyte *)0 + offset);
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	};
+	bind_instance(orbit_conic_program->InstanceOrigin_vec3, 3, GL_FLOAT, GL_FALSE, offsetof(OrbitConics::Instance, origin));
+	bind_instance(orbit_conic_program->InstanceConic_vec4, 4, GL_FLOAT, GL_FALSE, offsetof(OrbitConics::Instance, conic));
+	bind_instance(orbit_conic_program->InstanceRange_vec2, 2, GL_FLOAT, GL_FALSE, offsetof(OrbitConics::Instance, range));
+	bind_instance(orbit_conic_program->InstanceColor_vec4, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(OrbitConics::Instance, color));
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	GL_ERRORS(); //PARANOIA: make sure nothing strange happened during setup
+});
+
+OrbitConics::OrbitConics(glm::mat4 const &world_to_clip_) : world_to_clip(world_to_clip_) {
+}
+
+void OrbitConics::draw(Orbit const &orbit, glm::u8vec4 const &color) {
+	if (!(orbit.c < 1.0) || orbit.p <= Orbit::MinPForDegen) return;
+
+	//theta winds up over many revolutions; only its angle matters, and float cos() wants it small:
+	double start = std::remainder(orbit.theta, 2.0 * M_PI);
+	instances.emplace_back(
+		glm::vec3(orbit.origin->pos),
+		glm::vec4(orbit.c, orbit.p, orbit.phi, orbit.incl),
+		glm::vec2(start, 2.0 * M_PI),
+		color
+	);
+}
+
+OrbitConics::~OrbitConics() {
+	if (instances.empty()) return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	GLsizeiptr size = GLsizeiptr(instances.size() * sizeof(Instance));
+	//grow geometrically, so a rising count doesn't reallocate every frame:
+	if (size > instance_capacity) instance_capacity = std::max(size, 2 * instance_capacity);
+	//fresh storage (orphaning last frame's) rather than wait for the GPU to finish reading it:
+	glBufferData(GL_ARRAY_BUFFER, instance_capacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glUseProgram(orbit_conic_program->program);
+	glUniformMatrix4fv(orbit_conic_program->WORLD_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(world_to_clip));
+	glUniform1i(orbit_conic_program->SEGMENTS_int, Segments);
+
+	glBindVertexArray(instance_buffer_for_orbit_conic_program);
+	glDrawArraysInstanced(GL_LINE_STRIP, 0, Segments + 1, GLsizei(instances.size()));
+	glBindVertexArray(0);
+
+	glUseProgram(0);
+
+	GL_ERRORS();
+}
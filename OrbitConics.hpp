@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+ * Draws closed orbits from their elements alone: the vertex shader (see OrbitConicProgram) evaluates r(theta)
+ * along a fixed-length line strip, so no points are predicted or uploaded, and each orbit costs one small
+ * per-instance record. Every orbit given to one OrbitConics is drawn with a single instanced call.
+ *
+ * Open paths (which end at an SOI boundary) are drawn from their predicted points instead, see OrbitLines.
+ *
+ * Similar usage pattern to DrawLines.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+struct Orbit;
+
+struct OrbitConics {
+	//Start drawing; will remember world_to_clip matrix:
+	OrbitConics(glm::mat4 const &world_to_clip);
+
+	//draw one revolution of orbit, fading from where its orbiter is now (does nothing unless the orbit is closed):
+	void draw(Orbit const &orbit, glm::u8vec4 const &color);
+
+	//Finish drawing (push instances to GPU):
+	~OrbitConics();
+
+	static int constexpr Segments = 256; //lines per revolution
+
+	glm::mat4 world_to_clip;
+	struct Instance {
+		Instance(glm::vec3 const &origin_, glm::vec4 const &conic_, glm::vec2 const &range_, glm::u8vec4 const &color_)
+			: origin(origin_), conic(conic_), range(range_), color(color_) { }
+		glm::vec3 origin; //world position of the focus
+		glm::vec4 conic; //c, p, phi, incl
+		glm::vec2 range; //starting true anomaly, span
+		glm::u8vec4 color;
+	};
+	static_assert(sizeof(Instance) == 3*4 + 4*4 + 2*4 + 4, "Instance is packed.");
+	std::vector< Instance > instances;
+};
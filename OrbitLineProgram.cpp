@@ -0,0 +1,50 @@
+#include "OrbitLineProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+Load< OrbitLineProgram > orbit_line_program(LoadTagEarly);
+
+OrbitLineProgram::OrbitLineProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"uniform vec4 COLOR;\n"
+		"uniform int FADE_START;\n"
+		"uniform int FADE_LENGTH;\n"
+		"in vec4 Position;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		"	gl_Position = OBJECT_TO_CLIP * Position;\n"
+		"	//brightest at the orbiter, dimming along the path ahead (points behind it come last, wrapping around):\n"
+		"	int ahead = gl_VertexID - FADE_START;\n"
+		"	if (ahead < 0) ahead += FADE_LENGTH;\n"
+		"	color = vec4(COLOR.rgb, COLOR.a * max(0.2, float(FADE_LENGTH - ahead) / float(FADE_LENGTH)));\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"in vec4 color;\n"
+		"layout (location = 0) out vec4 fragColor;\n"
+		"layout (location = 1) out vec4 brightColor;\n"
+		"void main() {\n"
+		"	fragColor = color;\n"
+		"	brightColor = color;\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Position_vec4 = glGetAttribLocation(program, "Position");
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+	COLOR_vec4 = glGetUniformLocation(program, "COLOR");
+	FADE_START_int = glGetUniformLocation(program, "FADE_START");
+	FADE_LENGTH_int = glGetUniformLocation(program, "FADE_LENGTH");
+}
+
+OrbitLineProgram::~OrbitLineProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
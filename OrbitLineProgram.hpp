@@ -0,0 +1,24 @@
+#pragma once
+
+#include "GL.hpp"
+#include "Load.hpp"
+
+//Shader program for orbit paths (see OrbitLines): a line through an orbit's predicted points, in one color that
+// fades with distance (in points) ahead of FADE_START, where the orbiter is
+struct OrbitLineProgram {
+	OrbitLineProgram();
+	~OrbitLineProgram();
+
+	GLuint program = 0;
+	//Attribute (per-vertex variable) locations:
+	GLuint Position_vec4 = -1U;
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+	GLuint COLOR_vec4 = -1U;
+	GLuint FADE_START_int = -1U; //index of the point nearest the orbiter
+	GLuint FADE_LENGTH_int = -1U; //points over which the path fades out
+	//Textures:
+	// none
+};
+
+extern Load< OrbitLineProgram > orbit_line_program;
@@ -0,0 +1,101 @@
+#include "OrbitLines.hpp"
+#include "OrbitLineProgram.hpp"
+#include "OrbitalMechanics.hpp"
+
+#include "gl_errors.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/norm.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//GPU copy of one orbit's points, relative to its origin:
+struct OrbitBuffer {
+	GLuint buffer = 0;
+	GLuint vao = 0;
+	uint64_t revision = 0; //Orbit::points_revision as of the last upload
+	GLsizei count = 0; //points drawn, i.e. up to the first one outside the SOI
+	bool closed = false; //path wraps back around to its first point
+	bool drawn = false; //by the current OrbitLines
+};
+
+//n.b. declared static so they don't conflict with similarly named global variables elsewhere:
+static std::unordered_map< Orbit const *, OrbitBuffer > orbit_buffers;
+static std::vector< glm::vec3 > upload_points; //reused between uploads
+
+//copy orbit's points to the GPU:
+static void upload(Orbit const &orbit, OrbitBuffer &ob) {
+	std::vector< glm::dvec3 > const &points = orbit.points;
+	size_t n = points.size();
+
+	//same cutoff as the path always had: stop at the first point past the SOI (or absurdly far away)
+	size_t count = 0;
+	while (count < n && points[count] != Orbit::Invalid && glm::l2Norm(points[count]) <= 1e8) count++;
+
+	upload_points.clear();
+	upload_points.reserve(count);
+	for (size_t i = 0; i < count; i++) upload_points.emplace_back(points[i]);
+
+	if (ob.buffer == 0) {
+		glGenBuffers(1, &ob.buffer);
+		glGenVertexArrays(1, &ob.vao);
+		glBindVertexArray(ob.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, ob.buffer);
+		glVertexAttribPointer(orbit_line_program->Position_vec4, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLbyte *)0);
+		glEnableVertexAttribArray(orbit_line_program->Position_vec4);
+		glBindVertexArray(0);
+	} else {
+		glBindBuffer(GL_ARRAY_BUFFER, ob.buffer);
+	}
+	glBufferData(GL_ARRAY_BUFFER, upload_points.size() * sizeof(glm::vec3), upload_points.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	ob.revision = orbit.points_revision;
+	ob.count = GLsizei(count);
+	ob.closed = (count == n && n >= 2);
+}
+
+OrbitLines::OrbitLines(glm::mat4 const &world_to_clip_) : world_to_clip(world_to_clip_) {
+	glUseProgram(orbit_line_program->program);
+}
+
+void OrbitLines::draw(Orbit const &orbit, glm::u8vec4 const &color) {
+	if (orbit.points.empty()) return;
+
+	OrbitBuffer &ob = orbit_buffers[&orbit];
+	if (ob.buffer == 0 || ob.revision != orbit.points_revision) upload(orbit, ob);
+	ob.drawn = true;
+	if (ob.count < 2) return;
+
+	glm::mat4 object_to_clip = glm::translate(world_to_clip, glm::vec3(orbit.origin->pos));
+	glUniformMatrix4fv(orbit_line_program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(object_to_clip));
+	glUniform4fv(orbit_line_program->COLOR_vec4, 1, glm::value_ptr(glm::vec4(color) / 255.0f));
+	glUniform1i(orbit_line_program->FADE_START_int, GLint(orbit.point_index(orbit.theta)));
+	glUniform1i(orbit_line_program->FADE_LENGTH_int, GLint(orbit.points.size()));
+
+	glBindVertexArray(ob.vao);
+	glDrawArrays(ob.closed ? GL_LINE_LOOP : GL_LINE_STRIP, 0, ob.count);
+}
+
+OrbitLines::~OrbitLines() {
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	//anything not drawn this time may belong to an orbit that no longer exists:
+	for (auto it = orbit_buffers.begin(); it != orbit_buffers.end(); ) {
+		OrbitBuffer &ob = it->second;
+		if (ob.drawn) {
+			ob.drawn = false;
+			++it;
+		} else {
+			glDeleteVertexArrays(1, &ob.vao);
+			glDeleteBuffers(1, &ob.buffer);
+			it = orbit_buffers.erase(it);
+		}
+	}
+
+	GL_ERRORS();
+}
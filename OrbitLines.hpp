@@ -0,0 +1,28 @@
+#pragma once
+
+/*
+ * Draws orbits from copies of their predicted points kept on the GPU, which are only re-uploaded when
+ * Orbit::points_revision says the points have changed. Per orbit and frame that leaves a few uniforms and one
+ * draw call, so orbits that are not being re-predicted (i.e. those of bodies) cost no per-point work at all.
+ *
+ * Similar usage pattern to DrawLines: make one per frame. Copies belonging to orbits not drawn while it existed
+ * are freed when it is destroyed, as those orbits may be gone.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+struct Orbit;
+
+struct OrbitLines {
+	//Start drawing; will remember world_to_clip matrix:
+	OrbitLines(glm::mat4 const &world_to_clip);
+
+	//draw the points of orbit (but not of its continuation) around its origin's current position:
+	void draw(Orbit const &orbit, glm::u8vec4 const &color);
+
+	//Finish drawing (and free copies of orbits that weren't drawn):
+	~OrbitLines();
+
+	glm::mat4 world_to_clip;
+};
@@ -1,12 +1,12 @@
 #include "OrbitalMechanics.hpp"
-#include "Load.hpp"
-#include "Scene.hpp"
-#include "data_path.hpp"
-#include "Utils.hpp"
-#include "glm/gtc/type_ptr.hpp"
+#include "Predictor.hpp"
+#include "RootFinding.hpp"
 
 #include <glm/gtx/norm.hpp>
 
+#include <algorithm>
+#include <atomic>
+
 #define DEBUG
 #ifdef DEBUG
 #include <iostream>
@@ -21,26 +21,6 @@
 #define M_PI 3.14159265358979323846264
 #endif
 
-#define PARTICLE_COUNT 100
-
-Load< Scene::RenderSet > particles(LoadTagDefault, []() -> Scene::RenderSet const * {
-	Scene::RenderSet *renderSet = new Scene::RenderSet();
-	MeshBuffer const *ret = new MeshBuffer(data_path("assets/model/particles.pnct"));
-	renderSet->vao = ret->make_vao_for_program(emissive_program->program);
-	renderSet->meshes = ret;
-	renderSet->pipeline = emissive_program_pipeline;
-
-	return renderSet;
-});
-
-Load< Sound::Sample > laser_sfx(LoadTagDefault, []() -> Sound::Sample const * {
-	return new Sound::Sample(data_path("assets/sound/laser.wav"));
-});
-Load< Sound::Sample > engine_sfx(LoadTagDefault, []() -> Sound::Sample const * {
-	return new Sound::Sample(data_path("assets/sound/engine.wav"));
-});
-
-
 //universal time
 double universal_time = 0.0;
 
@@ -49,6 +29,36 @@ double universal_time = 0.0;
 DilationLevel dilation = LEVEL_0;
 static DilationLevel constexpr MAX_SOI_TRANS_DILATION = LEVEL_3;
 
+bool on_rails = false;
+double rails_step = 0.0;
+static double constexpr RailsApproach = 0.25; //real seconds over which rails warp covers most of the way to an event
+static double constexpr RailsMinRate = static_cast< double >(LEVEL_5); //never crawl slower than the top level
+static double constexpr RailsIdleRate = 1.0e7; //with no event ahead, warp at this fixed rate
+
+double dilated(double elapsed) {
+	return on_rails ? rails_step : elapsed * static_cast< double >(dilation);
+}
+
+bool plan_rails_step(double elapsed, double next_event) {
+	double remaining = next_event - universal_time;
+	if (!std::isfinite(remaining)) {
+		rails_step = elapsed * RailsIdleRate;
+		return false;
+	}
+	if (remaining <= elapsed) { //already there (or past it), finish with a real-time frame
+		rails_step = elapsed;
+		return true;
+	}
+
+	//exponential approach, so long coasts take about as long as short ones
+	rails_step = std::max(remaining * std::min(elapsed / RailsApproach, 1.0), elapsed * RailsMinRate);
+	if (rails_step >= remaining) {
+		rails_step = remaining;
+		return true;
+	}
+	return false;
+}
+
 DilationLevel operator++(DilationLevel &level, int) {
 	switch (level) {
 	case LEVEL_0:
@@ -127,11 +137,23 @@ void Body::set_orbit(Orbit *orbit_) {
 	if (orbit == nullptr) return;
 	pos = orbit->get_pos();
 	vel = orbit->get_vel();
-	orbit->predict();
+	//NOTE: bodies keep no predicted points, closed orbits are drawn straight from their elements (see OrbitConics)
+
+	epoch_time = universal_time;
+	epoch_M = orbit->p > 0.0 ? orbit->true_to_mean(orbit->theta) : 0.0;
+	epoch_rpos = orbit->rpos;
+	epoch_rvel = orbit->rvel;
+
+	//pellets are never looked up by prediction, so don't spend a fit on them
+	if (id >= 0 && orbit->p > 0.0 && orbit->c < Ephemeris::MaxEccentricity) {
+		ephemeris.build(*orbit);
+	} else {
+		ephemeris.clear();
+	}
 }
 
 void Body::update(double elapsed) {
-	transform->rotation = transform->rotation * glm::quat(glm::dvec3(0., 0., (2 * M_PI) * dilation * (elapsed / dayLengthInSeconds)));
+	spin = std::fmod(spin + (2 * M_PI) * (dilated(elapsed) / dayLengthInSeconds), 2 * M_PI);
 
 	if (orbit != nullptr) {
 		orbit->update(elapsed);
@@ -139,9 +161,6 @@ void Body::update(double elapsed) {
 		vel = orbit->get_vel();
 	}
 
-	assert(transform != nullptr);
-	transform->position = pos;
-
 	//Recursively update all satellites, their satellites, and so on
 	for (Body *body : satellites) {
 		assert(body != nullptr);
@@ -149,67 +168,76 @@ void Body::update(double elapsed) {
 	}
 }
 
-void Body::init_sim() {
-	if (orbit != nullptr) orbit->init_sim();
-	for (Body *satellite : satellites) {
-		satellite->init_sim();
+void Particle::attach(OrbitBatch &batch) {
+	assert(orbit != nullptr);
+	if (orbit->p > 0.0 && orbit->c < 1.0) {
+		batch_handle = batch.add(*orbit);
 	}
 }
 
-void Body::simulate(double time) {
-	if (id < 0) // optimization so the pellets don't re-simulate orbit
-		return;
+void Particle::attach(NBodyBatch &field) {
+	assert(orbit != nullptr);
+	pos = orbit->get_pos();
+	vel = orbit->get_vel();
+	nbody_handle = field.add(pos, vel);
+}
 
-	if (orbit != nullptr) {
-		orbit->simulate(time);
+void Particle::update(double elapsed, OrbitBatch const &batch, NBodyBatch const &field) {
+	if (nbody_handle != NBodyBatch::InvalidHandle) {
+		spin = std::fmod(spin + (2 * M_PI) * (dilated(elapsed) / dayLengthInSeconds), 2 * M_PI);
+		pos = field.get_pos(nbody_handle);
+		vel = field.get_vel(nbody_handle);
+		return;
 	}
 
-	//Recursively simulate all satellites, their satellites, and so on
-	for (Body *body : satellites) {
-		assert(body != nullptr);
-		body->simulate(time);
+	if (batch_handle == OrbitBatch::InvalidHandle) {
+		Body::update(elapsed);
+		return;
 	}
-}
 
-void Body::draw_orbits(DrawLines &lines, glm::u8vec4 const &color, double scale) {
-	if (orbit != nullptr && scale >= orbit->p) orbit->draw(lines, color);
+	spin = std::fmod(spin + (2 * M_PI) * (dilated(elapsed) / dayLengthInSeconds), 2 * M_PI);
 
-	for (Body *body : satellites) {
-		assert(body != nullptr);
-		if (body->id >= 0)
-			body->draw_orbits(lines, color, scale);
-	}
+	assert(orbit != nullptr);
+	batch.read(batch_handle, *orbit);
+	pos = orbit->get_pos();
+	vel = orbit->get_vel();
 }
 
-void Beam::draw(DrawLines &DL) const {
-	// drawing one timestep "ago" since the time dilation makes it really fast
-	// ==> so that we always see the start of the beam at the rocket
-	// "mass" equates to beam strength which dissipates over time (opacity)
-	const glm::dvec3 start = pos - compute_delta_pos();
-	const glm::dvec3 &end = pos;
+void Particle::refit_orbit() {
+	if (nbody_handle == NBodyBatch::InvalidHandle) return; //conic particles are always on theirs
+	assert(orbit != nullptr);
+	*orbit = Orbit(orbit->origin, pos, vel, false);
+}
 
-	/// NOTE: we are drawing many lines per dilation to account for opacity shift
-	const glm::dvec3 delta = (end - start) / static_cast<double>(dilation);
-	for (int i = 0; i < dilation; i++) {
-		glm::dvec3 istart = start + static_cast<double>(i) * delta;
-		double mass = get_mass(istart + delta);
-		if (mass < 1.0e-2) break;
-		DL.draw(istart, istart + delta, glm::u8vec4{col.x, col.y, col.z, mass * col.w});
+void Body::state_at(double time, glm::dvec3 &rpos_, glm::dvec3 &rvel_) const {
+	assert(orbit != nullptr);
+	if (ephemeris.valid()) {
+		ephemeris.eval(epoch_M + orbit->mean_motion * (time - epoch_time), rpos_, rvel_);
+	} else { //no fit for this orbit, propagate it directly
+		rpos_ = epoch_rpos;
+		rvel_ = epoch_rvel;
+		orbit->propagate_universal(rpos_, rvel_, time - epoch_time);
 	}
 }
 
 glm::dvec3 Beam::compute_delta_pos() const {
-	// used to compute the delta to where this beam will be in 1 timestep (dt)
-	return vel * heading * dt * static_cast< double >(dilation);
+	// used to compute the delta to where this beam will be in 1 timestep (dt), at the same warp as everything else
+	return vel * heading * dilated(dt);
 }
 
 bool Beam::collide(glm::dvec3 x) const {
 	glm::dvec3 prev_pos = pos - compute_delta_pos();
-	return glm::l2Norm(pos - x) + glm::l2Norm(prev_pos - x) - glm::l2Norm(pos - prev_pos) < 0.1f;
+	return glm::l2Norm(pos - x) + glm::l2Norm(prev_pos - x) - glm::l2Norm(pos - prev_pos) < CollideSlack;
+}
+
+double Beam::reach() const {
+	//collide() accepts the inside of an ellipse with foci at both ends of the step, its semi-minor axis bounds that
+	double len = glm::l2Norm(compute_delta_pos());
+	return std::sqrt(0.5 * CollideSlack * len + 0.25 * CollideSlack * CollideSlack);
 }
 
 double Beam::inverse_sq(glm::dvec3 const &x, glm::dvec3 const &start) {
-	double denom = 1.0 + glm::l2Norm(x - start) * 0.05;
+	double denom = 1.0 + glm::l2Norm(x - start) * Falloff;
 	return 1.0 / (denom * denom);
 }
 
@@ -217,50 +245,29 @@ double Beam::get_mass(glm::dvec3 x) const {
 	return Beam::inverse_sq(x, start_pos);
 }
 
-void Rocket::init(Scene::Transform *transform_, Body *root_, Scene *scene, Asteroid const &asteroid) {
-	assert(transform_ != nullptr);
-
+void Rocket::init(Body *root_, Asteroid const &asteroid) {
 	root = root_;
 	Orbit &orbit = orbits.front();
 	pos = orbit.get_pos();
 	vel = orbit.get_vel();
 	acc = glm::dvec3(0.0);
-	orbit.sim_predict(root, orbits, 0, orbits.begin(), universal_time);
-	orbit.find_closest_approach(asteroid.orbits.front(), 0, 0, closest);
-
-	transform = transform_;
-	transform->position = pos;
-	transform->scale = glm::dvec3(radius);
-
-	thrustParticles.reserve(PARTICLE_COUNT);
-	for(int i = 0; i < PARTICLE_COUNT; i++){
-		scene->transforms.emplace_back();
-		auto it = scene->transforms.end();
-		it--;
-		it->name = "Particle";
-		auto drawable = Scene::make_drawable(*scene, &(*it), particles);
-		thrustParticles.push_back(ThrustParticle(it, 5.0, glm::dvec3(0), 0.04));
-		ThrustParticle *currentParticle = &thrustParticles[thrustParticles.size() - 1];
-		drawable->set_uniforms = [currentParticle]() {
-			glUniform4fv(emissive_program->COLOR_vec4, 1, glm::value_ptr(currentParticle->color));
-		};
-		it->enabled = false;
-	}
-
-	engine_loop = Sound::loop(*engine_sfx, static_cast< float >(thrust_percent) / 100.0f, 0.0f);
+	orbit.sim_predict(orbits, 0, orbits.begin(), universal_time);
+	orbit.find_closest_approach(asteroid.orbits.front(), closest);
+	time_of_collision = orbit.find_time_of_collision();
+	if (!predictor) predictor = std::make_shared< Predictor >();
 }
 
 glm::dvec3 Rocket::get_heading() const {
 	return {std::cos(theta), std::sin(theta), 0.0};
 }
 
-void Rocket::fire_laser() {
-	if (laser_timer > 0.0) return;
+bool Rocket::fire_laser() {
+	if (laser_timer > 0.0) return false;
 
 	lasers.emplace_back(Beam(pos, aim_dir));
-	Sound::play(*laser_sfx, 0.5, 0.0);
 
 	laser_timer = LaserCooldown;
+	return true;
 }
 
 void Rocket::update_lasers(double elapsed) {
@@ -279,46 +286,8 @@ void Rocket::update_lasers(double elapsed) {
 void Rocket::update(double elapsed, Asteroid const &asteroid) {
 	bool moved = false;
 
-	engine_loop->set_volume(static_cast< float >(thrust_percent) / 100.0f);
 	if (laser_timer > 0.0) {
-		laser_timer = std::max(laser_timer - elapsed * dilation, 0.0);
-	}
-
-	{ //update thrust particles
-		if (thrust_percent > 0){
-			double rate = glm::mix(0.0, 250.0, std::min((thrust_percent / 10.0), 1.0));
-			while (timeSinceLastParticle > (1.0 / rate)) {
-				auto particle = &thrustParticles[lastParticle];
-				auto trans = thrustParticles[lastParticle].transform;
-				trans->position = transform->make_local_to_world() * glm::vec4(
-					-3.5, Utils::RandBetween(-0.5, 0.5), Utils::RandBetween(-0.5, 0.5), 1
-				);
-				trans->scale = glm::dvec3(0.1,0.1,0.1);
-				particle->_t = 0;
-				timeSinceLastParticle -= (1.0 / rate);
-				glm::dvec3 velocity = transform->make_local_to_world() * glm::vec4(
-					Utils::RandBetween(-10.5f, -5.0f), 0, 0, 0.0
-				);
-				particle->velocity = velocity;
-				particle->color = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
-				particle->lifeTime = Utils::RandBetween(0.34f, 0.36f);
-				trans->enabled = true;
-				lastParticle = (1 + lastParticle) % PARTICLE_COUNT;
-			}
-			timeSinceLastParticle += elapsed;
-		}
-
-		for (auto &particle : thrustParticles) {
-			if (!particle.transform->enabled) continue;
-			particle._t += elapsed;
-			if (particle._t >= particle.lifeTime) {
-				particle.transform->enabled = false;
-			}
-			particle.transform->position += particle.velocity * elapsed;
-			double a = (particle.lifeTime - particle._t) / particle.lifeTime;
-			particle.transform->scale = glm::dvec3(particle.scale * a);
-			particle.color = glm::vec4(1, (1 - a), 0, 1);
-		}
+		laser_timer = std::max(laser_timer - dilated(elapsed), 0.0);
 	}
 
 	{ //rocket controls & physics
@@ -330,7 +299,6 @@ void Rocket::update(double elapsed, Asteroid const &asteroid) {
 			theta -= 2 * M_PI;
 		if (theta < -M_PI)
 			theta += 2 * M_PI;
-		transform->rotation = glm::quat(glm::dvec3(0., 0., theta));
 
 		if (thrust_percent != 0.0 && fuel > 0.0) {
 			moved = true; //set flag to trigger orbit recalc later on
@@ -345,7 +313,7 @@ void Rocket::update(double elapsed, Asteroid const &asteroid) {
 			);
 
 			//update fuel consumption
-			fuel = std::max(fuel - std::fabs(thrust_percent) * MaxFuelConsumption, 0.0);
+			fuel = std::max(fuel - std::fabs(thrust_percent) * MaxFuelConsumption * elapsed, 0.0);
 
 			//update velocity
 			vel += acc * elapsed;
@@ -356,17 +324,21 @@ void Rocket::update(double elapsed, Asteroid const &asteroid) {
 
 	{ //orbital mechanics
 		Orbit &orbit = orbits.front();
+		if (predictor->poll() && predictor->current.adopt(orbits)) {
+			closest = predictor->current.closest;
+			time_of_collision = predictor->current.time_of_collision;
+		}
+
 		if (moved) {
-			//recalculate orbit due to thrust
-			Orbit *temp = orbit.continuation;
-			orbit = Orbit(orbit.origin, pos, vel, false);
-			orbit.continuation = temp;
-			orbit.sim_predict(root, orbits, 0, orbits.begin(), universal_time);
-			closest.dist = std::numeric_limits< double >::infinity();
-			orbit.find_closest_approach(asteroid.orbits.front(), 0, 0, closest);
+			//recalculate orbit due to thrust, showing the previous prediction until the new one is ready
+			Orbit next(orbit.origin, pos, vel, false);
+			next.take_prediction(orbit);
+			orbit = next;
+			predictor->request(orbit, universal_time, &asteroid.orbits);
 		}
 
-		while (orbit.will_soi_transit(elapsed) && dilation > MAX_SOI_TRANS_DILATION) {
+		//(on rails, dilation doesn't set the step; plan_rails_step() already stops at the SOI transit)
+		while (!on_rails && orbit.will_soi_transit(elapsed) && dilation > MAX_SOI_TRANS_DILATION) {
 			dilation--;
 		}
 
@@ -384,43 +356,33 @@ void Rocket::update(double elapsed, Asteroid const &asteroid) {
 			Body *new_origin = origin->orbit->origin;
 
 			orbit = Orbit(new_origin, pos, vel, false);
-			orbit.sim_predict(root, orbits, 0, orbits.begin(), universal_time);
-			closest.dist = std::numeric_limits< double >::infinity();
-			orbit.find_closest_approach(asteroid.orbits.front(), 0, 0, closest);
+			orbit.clear_prediction();
+			predictor->request(orbit, universal_time, &asteroid.orbits);
 		}
 
 		for (Body *satellite : origin->satellites) {
 			if (satellite->in_soi(pos)) {
 				orbit = Orbit(satellite, pos, vel, false);
-				orbit.sim_predict(root, orbits, 0, orbits.begin(), universal_time);
-				closest.dist = std::numeric_limits< double >::infinity();
-				orbit.find_closest_approach(asteroid.orbits.front(), 0, 0, closest);
+				orbit.clear_prediction();
+				predictor->request(orbit, universal_time, &asteroid.orbits);
 				break;
 			}
 		}
-
-		assert(transform != nullptr);
-		transform->position = pos;
 	}
 
-	universal_time += elapsed * dilation;
+	universal_time += dilated(elapsed);
 }
 
 
-void Asteroid::init(Scene::Transform *transform_, Body *root_) {
-	assert(transform_ != nullptr);
-
+void Asteroid::init(Body *root_) {
 	root = root_;
 	Orbit &orbit = orbits.front();
 	pos = orbit.get_pos();
 	vel = orbit.get_vel();
 	acc = glm::dvec3(0.0);
-	orbit.sim_predict(root, orbits, 0, orbits.begin(), universal_time);
+	orbit.sim_predict(orbits, 0, orbits.begin(), universal_time);
 	time_of_collision = orbit.find_time_of_collision();
-
-	transform = transform_;
-	transform->position = pos;
-	transform->scale = glm::dvec3(radius);
+	if (!predictor) predictor = std::make_shared< Predictor >();
 }
 
 void Asteroid::update(double elapsed, std::deque< Beam > const &lasers) {
@@ -455,16 +417,26 @@ void Asteroid::update(double elapsed, std::deque< Beam > const &lasers) {
 
 	{ //orbital mechanics
 		Orbit &orbit = orbits.front();
+		if (predictor->poll() && predictor->current.adopt(orbits)) {
+			time_of_collision = predictor->current.time_of_collision;
+		}
+
 		if (moved) {
-			//recalculate orbit due to thrust
-			Orbit *temp = orbit.continuation;
-			orbit = Orbit(orbit.origin, pos, vel, false);
-			orbit.continuation = temp;
-			orbit.sim_predict(root, orbits, 0, orbits.begin(), universal_time);
-			time_of_collision = orbit.find_time_of_collision();
+			//recalculate orbit due to laser, showing the previous prediction until the new one is ready
+			Orbit next(orbit.origin, pos, vel, false);
+			next.take_prediction(orbit);
+			orbit = next;
+			predictor->request(orbit, universal_time);
+
+			//an impact before leaving the current SOI follows straight from the new conic, later ones wait on the predictor
+			double impact = orbit.time_until_radius(orbit.theta, orbit.origin->radius, true);
+			if (impact < orbit.time_until_radius(orbit.theta, orbit.origin->soi_radius)) {
+				time_of_collision = universal_time + impact;
+			}
 		}
 
-		while (orbit.will_soi_transit(elapsed) && dilation > MAX_SOI_TRANS_DILATION) {
+		//(on rails, dilation doesn't set the step; plan_rails_step() already stops at the SOI transit)
+		while (!on_rails && orbit.will_soi_transit(elapsed) && dilation > MAX_SOI_TRANS_DILATION) {
 			dilation--;
 		}
 
@@ -482,42 +454,38 @@ void Asteroid::update(double elapsed, std::deque< Beam > const &lasers) {
 			Body *new_origin = origin->orbit->origin;
 
 			orbit = Orbit(new_origin, pos, vel, false);
-			orbit.sim_predict(root, orbits, 0, orbits.begin(), universal_time);
-			time_of_collision = orbit.find_time_of_collision();
+			orbit.clear_prediction();
+			predictor->request(orbit, universal_time);
 		}
 
 		for (Body *satellite : origin->satellites) {
 			if (satellite->in_soi(pos)) {
 				orbit = Orbit(satellite, pos, vel, false);
-				orbit.sim_predict(root, orbits, 0, orbits.begin(), universal_time);
-				time_of_collision = orbit.find_time_of_collision();
+				orbit.clear_prediction();
+				predictor->request(orbit, universal_time);
 				break;
 			}
 		}
-
-		assert(transform != nullptr);
-		transform->position = pos;
 	}
 }
 
-Orbit::Orbit(Body *origin_, glm::dvec3 pos, glm::dvec3 vel, bool simulated, bool verbose) : origin(origin_) {
+Orbit::Orbit(Body *origin_, glm::dvec3 pos, glm::dvec3 vel, bool relative, bool verbose) : origin(origin_) {
 	//Math references:
 	//https://orbital-mechanics.space/classical-orbital-elements/orbital-elements-and-the-state-vector.html
 	//https://scienceworld.wolfram.com/physics/SemilatusRectum.html
 
-	// LOG("Entering new orbit around: " << origin_->transform->name);
+	// LOG("Entering new orbit around body #" << origin_->id);
 	// LOG("\tentry pos: " << glm::to_string(pos));
 	// LOG("\tentry vel: " << glm::to_string(vel));
 
 	mu = G * origin->mass;
 	glm::dvec3 d, v;
-	if (!simulated || origin->orbit == nullptr) {
+	if (relative) {
+		d = pos;
+		v = vel;
+	} else {
 		d = pos - origin->pos; //relative position
 		v = vel - origin->vel; //relative velocity
-	} else {
-		Orbit *orbit = origin->orbit;
-		d = pos - orbit->sim.pos; //relative position
-		v = vel - orbit->sim.vel; //relative velocity
 	}
 
 	glm::dvec3 hvec = glm::cross(d, v); //specific orbital angular momentum
@@ -549,12 +517,11 @@ Orbit::Orbit(Body *origin_, glm::dvec3 pos, glm::dvec3 vel, bool simulated, bool
 		phi = glm::atan(e.y, e.x);
 	}
 
-	if (std::abs(c - 1.0) > 1.0e-5) {
-		a = p / (1.0f - c * c);
-	} else {
-		a = std::numeric_limits< double >::infinity();
-	}
-	inv_a = 1.0 / a;
+	//1/a from vis-viva stays finite for every conic, even radial freefall (p == 0, c == 1); a itself becomes infinite
+	// for a true parabola
+	inv_a = 2.0 / glm::l2Norm(d) - glm::length2(v) / mu;
+	a = 1.0 / inv_a;
+	compute_mean_motion();
 
 	// LOG("\tc: " << c << " p: " << p << " phi: " << phi << " a: " << a << " incl: " << incl);
 
@@ -591,14 +558,11 @@ Orbit::Orbit(Body *origin_, double c_, double p_, double phi_, double theta_, bo
 		: origin(origin_), c(c_), p(p_), phi(phi_), theta(theta_) {
 
 	incl = retrograde ? M_PI : 0.0;
-	if (c != 1.0) {
-		a = p / (1.0 - c * c);
-	} else {
-		a = std::numeric_limits< double >::infinity();
-	}
-	inv_a = 1.0 / a;
+	inv_a = (p > 0.0 ? (1.0 - c * c) / p : 0.0); //(no size to go on for a degenerate orbit, treat it as parabolic)
+	a = 1.0 / inv_a;
 	mu = G * origin->mass;
 	mu_over_h = mu / std::sqrt(mu * p);
+	compute_mean_motion();
 	rot = glm::dmat3(
 		std::cos(-phi), -std::sin(-phi), 0.0,
 		std::sin(-phi), std::cos(-phi), 0.0,
@@ -610,14 +574,93 @@ Orbit::Orbit(Body *origin_, double c_, double p_, double phi_, double theta_, bo
 	);
 
 	if (verbose) {
-		LOG("Created orbit around: " << origin_->transform->name);
+		LOG("Created orbit around body #" << origin_->id);
 		LOG("\tc: " << c << " p: " << p << " phi: " << phi << " a: " << a << " incl: " << incl);
 	}
 
 	init_dynamics();
 }
 
-glm::dvec3 Orbit::get_rpos(double theta_, double r_) {
+void Orbit::compute_mean_motion() {
+	//Mean anomaly advances linearly with time: https://en.wikipedia.org/wiki/Mean_motion
+	if (inv_a > 0.0) { //elliptic
+		mean_motion = std::sqrt(mu * inv_a * inv_a * inv_a);
+	} else if (inv_a < 0.0) { //hyperbolic
+		mean_motion = std::sqrt(-mu * inv_a * inv_a * inv_a);
+	} else if (p > 0.0) { //parabolic, see Barker's equation below
+		mean_motion = 2.0 * std::sqrt(mu / (p * p * p));
+	} else { //degenerate
+		mean_motion = 0.0;
+	}
+}
+
+double Orbit::true_to_mean(double theta_) const {
+	//NOTE: theta_ is expected to be wrapped to [-pi, pi]
+	//Anomaly conversions: https://en.wikipedia.org/wiki/Eccentric_anomaly
+	double half = 0.5 * theta_;
+	if (inv_a > 0.0) { //elliptic, via eccentric anomaly E
+		double E = 2.0 * std::atan2(std::sqrt(1.0 - c) * std::sin(half), std::sqrt(1.0 + c) * std::cos(half));
+		return E - c * std::sin(E);
+	} else if (inv_a < 0.0) { //hyperbolic, via hyperbolic anomaly H
+		//clamp so that numerical noise at the asymptotes doesn't blow up atanh
+		static double constexpr Limit = 1.0 - 1.0e-15;
+		double x = std::max(-Limit, std::min(Limit, std::sqrt((c - 1.0) / (c + 1.0)) * std::tan(half)));
+		double H = 2.0 * std::atanh(x);
+		return c * std::sinh(H) - H;
+	} else { //parabolic
+		double D = std::tan(half);
+		return D + D * D * D / 3.0;
+	}
+}
+
+double Orbit::mean_to_true(double M) const {
+	//Solve Kepler's equation for the given mean anomaly: https://en.wikipedia.org/wiki/Kepler%27s_equation
+	//Halley's method converges cubically from these starting guesses: https://en.wikipedia.org/wiki/Halley%27s_method
+	if (inv_a > 0.0) { //elliptic, M expected to be wrapped to [-pi, pi]
+		//Danby's starting guess
+		double E = M + 0.85 * c * (std::sin(M) >= 0.0 ? 1.0 : -1.0);
+		for (int i = 0; i < KeplerMaxIterations; i++) {
+			double esin = c * std::sin(E);
+			double f = E - esin - M;
+			double df = 1.0 - c * std::cos(E);
+			double dE = f / (df - 0.5 * f * esin / df);
+			E -= dE;
+			if (std::abs(dE) < KeplerTolerance) break;
+		}
+		return 2.0 * std::atan2(std::sqrt(1.0 + c) * std::sin(0.5 * E), std::sqrt(1.0 - c) * std::cos(0.5 * E));
+	} else if (inv_a < 0.0) { //hyperbolic
+		double H = (M >= 0.0 ? 1.0 : -1.0) * std::log(2.0 * std::abs(M) / c + 1.8);
+		for (int i = 0; i < KeplerMaxIterations; i++) {
+			double esinh = c * std::sinh(H);
+			double f = esinh - H - M;
+			double df = c * std::cosh(H) - 1.0;
+			double dH = f / (df - 0.5 * f * esinh / df);
+			H -= dH;
+			if (std::abs(dH) < KeplerTolerance * std::max(1.0, std::abs(H))) break;
+		}
+		return 2.0 * std::atan(std::sqrt((c + 1.0) / (c - 1.0)) * std::tanh(0.5 * H));
+	} else { //parabolic, Barker's equation is a cubic with a closed form solution
+		//https://en.wikipedia.org/wiki/Parabolic_trajectory#Barker's_equation
+		double B = 1.5 * M;
+		double z = std::cbrt(B + std::sqrt(1.0 + B * B));
+		return 2.0 * std::atan(z - 1.0 / z);
+	}
+}
+
+double Orbit::propagate(double theta_, double time) const {
+	//Advance true anomaly by time (in seconds) in closed form, one Kepler solve regardless of how far time jumps
+	//theta_ is allowed to wind past +-pi, so whole revolutions are split off and carried through
+	double revs = 2.0 * M_PI * std::round(theta_ / (2.0 * M_PI));
+	double M = true_to_mean(theta_ - revs) + mean_motion * time;
+	if (inv_a > 0.0) { //elliptic orbits repeat, so wrap mean anomaly as well
+		double wrap = 2.0 * M_PI * std::round(M / (2.0 * M_PI));
+		revs += wrap;
+		M -= wrap;
+	}
+	return revs + mean_to_true(M);
+}
+
+glm::dvec3 Orbit::get_rpos(double theta_, double r_) const {
 	return rot * glm::dvec3(
 		r_ * std::cos(theta_),
 		r_ * std::sin(theta_),
@@ -625,7 +668,7 @@ glm::dvec3 Orbit::get_rpos(double theta_, double r_) {
 	);
 }
 
-glm::dvec3 Orbit::get_rvel(double theta_) {
+glm::dvec3 Orbit::get_rvel(double theta_) const {
 	return rot * glm::dvec3(
 		-mu_over_h * std::sin(theta_),
 		mu_over_h * (c + std::cos(theta_)),
@@ -633,174 +676,387 @@ glm::dvec3 Orbit::get_rvel(double theta_) {
 	);
 }
 
+//Stumpff functions, using their series expansions near z == 0 to avoid cancellation:
+//https://en.wikipedia.org/wiki/Stumpff_function
+static double stumpff_c(double z) {
+	if (z > 1.0e-3) {
+		return (1.0 - std::cos(std::sqrt(z))) / z;
+	} else if (z < -1.0e-3) {
+		return (std::cosh(std::sqrt(-z)) - 1.0) / -z;
+	}
+	return 1.0 / 2.0 - z * (1.0 / 24.0 - z * (1.0 / 720.0 - z / 40320.0));
+}
+
+static double stumpff_s(double z) {
+	if (z > 1.0e-3) {
+		double sz = std::sqrt(z);
+		return (sz - std::sin(sz)) / (sz * sz * sz);
+	} else if (z < -1.0e-3) {
+		double sz = std::sqrt(-z);
+		return (std::sinh(sz) - sz) / (sz * sz * sz);
+	}
+	return 1.0 / 6.0 - z * (1.0 / 120.0 - z * (1.0 / 5040.0 - z / 362880.0));
+}
+
+void Orbit::propagate_universal(glm::dvec3 &rpos_, glm::dvec3 &rvel_, double time) const {
+	//Universal variable formulation of Kepler's problem, valid for every conic including radial (freefall)
+	// trajectories: https://en.wikipedia.org/wiki/Universal_variable_formulation
+	//Solved with the Laguerre-Conway iteration, which converges from a rough initial guess for all conics.
+	if (time == 0.0) return;
+
+	const double sqrt_mu = std::sqrt(mu);
+	const double r0 = glm::l2Norm(rpos_);
+	const double sigma0 = glm::dot(rpos_, rvel_) / sqrt_mu;
+	const double alpha = 2.0 / r0 - glm::length2(rvel_) / mu; //=1/a, by vis-viva
+
+	double x = alpha > 0.0 ? sqrt_mu * alpha * time : sqrt_mu * time / r0; //universal anomaly
+	double z = 0.0, C = 0.5, S = 1.0 / 6.0;
+	for (int i = 0; i < KeplerMaxIterations; i++) {
+		z = alpha * x * x;
+		C = stumpff_c(z);
+		S = stumpff_s(z);
+		double f = sigma0 * x * x * C + (1.0 - alpha * r0) * x * x * x * S + r0 * x - sqrt_mu * time;
+		double df = sigma0 * x * (1.0 - z * S) + (1.0 - alpha * r0) * x * x * C + r0;
+		double d2f = sigma0 * (1.0 - z * C) + (1.0 - alpha * r0) * x * (1.0 - z * S);
+		static double constexpr n = 5.0;
+		double root = std::sqrt(std::abs((n - 1.0) * (n - 1.0) * df * df - n * (n - 1.0) * f * d2f));
+		double dx = n * f / (df + (df >= 0.0 ? root : -root));
+		x -= dx;
+		if (std::abs(dx) < KeplerTolerance * std::max(1.0, std::abs(x))) break;
+	}
+	z = alpha * x * x;
+	C = stumpff_c(z);
+	S = stumpff_s(z);
+
+	//Lagrange coefficients
+	const double x2 = x * x;
+	const double f = 1.0 - x2 / r0 * C;
+	const double g = time - x2 * x / sqrt_mu * S;
+	const glm::dvec3 rpos_new = f * rpos_ + g * rvel_;
+	const double r_new = glm::l2Norm(rpos_new);
+	const double df = sqrt_mu / (r_new * r0) * x * (z * S - 1.0);
+	const double dg = 1.0 - x2 / r_new * C;
+
+	rvel_ = df * rpos_ + dg * rvel_;
+	rpos_ = rpos_new;
+}
+
+double Orbit::anomaly_of(glm::dvec3 const &rpos_, double theta_) const {
+	//true anomaly of a point on this orbit, unwrapped to stay continuous with theta_
+	glm::dvec3 local = glm::transpose(rot) * rpos_;
+	return theta_ + std::remainder(glm::atan(local.y, local.x) - theta_, 2.0 * M_PI);
+}
+
 void Orbit::update(double elapsed) {
-	const double time_step = elapsed * static_cast< double >(dilation) / static_cast< double >(UpdateSteps);
+	const double time = dilated(elapsed);
 	if (p == 0.0) { //degenerate case
-		glm::dvec3 drvel;
-		for (size_t i = 0; i < UpdateSteps; i++) {
-			double f = -mu / (r * r);
-			drvel = time_step * f * (rot * glm::dvec3(
-				std::cos(theta),
-				std::sin(theta),
-				0.0
-			));
-			rpos += (rvel + 0.5 * drvel) * time_step;
-			rvel += drvel;
-			r = glm::l2Norm(rpos);
-			theta = glm::atan(rpos.y, rpos.x);
-		}
+		propagate_universal(rpos, rvel, time);
+		r = glm::l2Norm(rpos);
+		theta = glm::atan(rpos.y, rpos.x);
+	} else if (is_near_parabolic()) { //anomalies are ill-conditioned here, propagate the state vector instead
+		propagate_universal(rpos, rvel, time);
+		r = glm::l2Norm(rpos);
+		theta = anomaly_of(rpos, theta);
+		compute_dtheta();
 	} else { //standard case
-		for (size_t i = 0; i < UpdateSteps; i++) {
-			theta += dtheta * time_step;
-			compute_r();
-			compute_dtheta();
-		}
+		theta = propagate(theta, time);
+		compute_r();
+		compute_dtheta();
 
 		rpos = get_rpos(theta, r);
 		rvel = get_rvel(theta);
 	}
 }
 
-void Orbit::predict() {
-	//Use this only for bodies, not for player
-	assert(c < 1.0);
-
-	for (size_t i = 0; i < PredictDetail; i++) {
-		double theta_ = static_cast< double >(i) * PredictAngle;
-		double r_ = compute_r(theta_);
+double Orbit::sample_arc(double r_) const {
+	//Curvature of a conic: |v x a| / |v|^3 with |a| = mu / r^2, which reduces to mu h / (r^3 v^3)
+	double v = std::sqrt(mu * (2.0 / r_ - inv_a));
+	double h = std::sqrt(mu * p);
+	double curvature = mu * h / (r_ * r_ * r_ * v * v * v);
+	//arc of length L on a circle of radius 1/curvature turns by L * curvature and strays L^2 * curvature / 8 from its chord
+	return std::min(PredictTurn / curvature, std::sqrt(8.0 * PredictChordError * r_ / curvature));
+}
 
-		points[i] = get_rpos(theta_, r_);
-	}
+void Orbit::take_prediction(Orbit &from) {
+	points = std::move(from.points);
+	point_times = std::move(from.point_times);
+	point_thetas = std::move(from.point_thetas);
+	points_revision = from.points_revision;
+	from.points_changed();
+	soi_transit = from.soi_transit;
+	continuation = from.continuation;
+	predicted_from = from.predicted_from;
 }
 
-void Orbit::init_sim() {
+void Orbit::init_sim(double time) {
 	sim.r = r;
 	sim.theta = theta;
 	sim.dtheta = dtheta;
-	sim.pos = get_pos();
-	sim.vel = get_vel();
+	sim.time = time;
 
 	sim.rpos = rpos;
 	sim.rvel = rvel;
 }
 
-void Orbit::sim_predict(
-		Body *root, std::list< Orbit > &orbits, int level, std::list< Orbit >::iterator it, double start_time) {
-	root->init_sim();
-	init_sim();
+void Orbit::sim_predict(std::list< Orbit > &orbits, int level, std::list< Orbit >::iterator it, double start_time) {
+	//Bodies are not stepped along with the prediction; they are looked up at sim.time instead
+	//NOTE: may run on the Predictor thread, so must not touch anything but this chain and fixed body data
+	init_sim(start_time);
+	predicted_from = sim;
 
 	double current_time = start_time;
-	points[0] = sim.rpos;
-	point_times[0] =  current_time;
+	points.clear();
+	point_times.clear();
+	point_thetas.clear();
+	points_changed();
+	//whatever was carried over (e.g. by take_prediction) no longer applies; set again below if this path transits:
+	soi_transit = std::numeric_limits< double >::infinity();
+	continuation = nullptr;
+	points.emplace_back(sim.rpos);
+	point_times.emplace_back(current_time);
+	point_thetas.emplace_back(sim.theta);
 	++it;
 
 	if (p == 0.0) { //degenerate case
-		points[1] = glm::dvec3(0.0);
-		points[2] = Invalid;
+		points.emplace_back(0.0);
+		point_times.emplace_back(current_time);
+		point_thetas.emplace_back(sim.theta);
+		points.emplace_back(Invalid);
+		point_times.emplace_back(current_time);
+		point_thetas.emplace_back(sim.theta);
 		return;
 	}
 
-	double aligned = std::ceil(sim.theta / PredictAngle) * PredictAngle;
-	double step = (aligned - sim.theta) / sim.dtheta;
-	for (size_t i = 1; i < PredictDetail; i++) {
-		root->simulate(step);
+	//SOI exit from origin is solved for directly, encounters with satellites are searched for within each step
+	double exit_time = current_time + time_until_radius(sim.theta, origin->soi_radius);
+
+	double swept = 0.0; //true anomaly covered so far
+	//NOTE: two slots are kept free for a transition point and the terminating Invalid point
+	while (points.size() + 2 < MaxPredictPoints) {
+		double step = sample_arc(sim.r) / glm::l2Norm(sim.rvel);
+		bool exiting = false;
+		if (current_time + step >= exit_time) {
+			step = exit_time - current_time;
+			exiting = true;
+		}
+
+		Simulation start = sim;
 		simulate(step);
 		current_time += step;
-		point_times[i] = current_time;
-		step = PredictAngle / sim.dtheta;
 
-		if (sim.r > origin->soi_radius) {
-			points[i] = Invalid;
-			soi_transit = sim.theta;
+		Body *encounter = nullptr;
+		double encounter_tau = step;
+		for (Body *satellite : origin->satellites) {
+			assert(satellite != nullptr && satellite->orbit != nullptr);
+			double tau;
+			if (find_encounter(satellite, start, encounter_tau, tau)) {
+				encounter = satellite;
+				encounter_tau = tau;
+			}
+		}
+		if (encounter != nullptr) {
+			sim = start;
+			simulate(encounter_tau);
+			current_time = sim.time;
+		}
+
+		//one full revolution without events: draw() wraps back around to the first point
+		swept += sim.theta - start.theta;
+		if (swept >= 2.0 * M_PI && encounter == nullptr && !exiting) break;
+
+		//NOTE: exit is also checked by distance, for near-parabolic orbits that time_until_radius leaves alone
+		if (encounter != nullptr || exiting || sim.r > origin->soi_radius) {
+			points.emplace_back(sim.rpos);
+			point_times.emplace_back(current_time);
+			point_thetas.emplace_back(sim.theta);
+			points.emplace_back(Invalid);
+			point_times.emplace_back(current_time);
+			point_thetas.emplace_back(sim.theta);
+			soi_transit = current_time;
 
 			if (level >= MaxLevel) return;
 
-			// SOI transfer to origin of origin
-			if (it == orbits.end()) {
+			Body *next_origin;
+			glm::dvec3 d, v;
+			if (encounter != nullptr) { // SOI transfer to satellite of origin
+				glm::dvec3 satellite_rpos, satellite_rvel;
+				encounter->state_at(sim.time, satellite_rpos, satellite_rvel);
+				next_origin = encounter;
+				d = sim.rpos - satellite_rpos;
+				v = sim.rvel - satellite_rvel;
+			} else { // SOI transfer to origin of origin
 				assert(origin->orbit != nullptr);
-				orbits.emplace_back(Orbit(origin->orbit->origin, sim.pos, sim.vel, true));
+				glm::dvec3 origin_rpos, origin_rvel;
+				origin->state_at(sim.time, origin_rpos, origin_rvel);
+				next_origin = origin->orbit->origin;
+				d = sim.rpos + origin_rpos;
+				v = sim.rvel + origin_rvel;
+			}
+
+			if (it == orbits.end()) {
+				orbits.emplace_back(Orbit(next_origin, d, v, true));
 				it = --orbits.end();
 				continuation = &orbits.back();
 			} else {
 				continuation = &(*it);
 				Orbit *temp = continuation->continuation;
-				*continuation = Orbit(origin->orbit->origin, sim.pos, sim.vel, true);
+				*continuation = Orbit(next_origin, d, v, true);
 				continuation->continuation = temp;
 			}
-			continuation->sim_predict(root, orbits, level+1, it, current_time);
+			continuation->sim_predict(orbits, level+1, it, current_time);
 			return;
 		}
 
-		for (Body *satellite : origin->satellites) {
-			assert(satellite != nullptr && satellite->orbit != nullptr);
-			if (glm::distance(sim.pos, satellite->orbit->sim.pos) < satellite->soi_radius) {
-				points[i] = Invalid;
-				soi_transit = sim.theta;
-
-				if (level >= MaxLevel) return;
-
-				// SOI transfer to satellite of origin
-				if (it == orbits.end()) {
-					orbits.emplace_back(Orbit(satellite, sim.pos, sim.vel, true));
-					it = --orbits.end();
-					continuation = &orbits.back();
-				} else {
-					continuation = &(*it);
-					Orbit *temp = continuation->continuation;
-					*continuation = Orbit(satellite, sim.pos, sim.vel, true);
-					continuation->continuation = temp;
-				}
-				continuation->sim_predict(root, orbits, level+1, it, current_time);
-				return;
-			}
-		}
-
-		points[i] = sim.rpos;
-		if (sim.r < origin->radius && i+1 < PredictDetail) { // Collision
-			points[i+1] = Invalid;
+		points.emplace_back(sim.rpos);
+		point_times.emplace_back(current_time);
+		point_thetas.emplace_back(sim.theta);
+		if (sim.r < origin->radius) { // Collision
 			break;
 		}
 	}
 
-	if (continuation != nullptr) {
-		soi_transit = std::numeric_limits< double >::infinity();
-		continuation = nullptr;
+	//ran out of points (or collided) before closing the loop, so terminate the path rather than wrap it
+	if (swept < 2.0 * M_PI) {
+		points.emplace_back(Invalid);
+		point_times.emplace_back(current_time);
+		point_thetas.emplace_back(sim.theta);
 	}
+
+	//no transit on this path (the transit branch returns above):
+	soi_transit = std::numeric_limits< double >::infinity();
+	continuation = nullptr;
 }
 
 void Orbit::simulate(double time) {
-	const double time_step = time / static_cast< double >(UpdateSteps);
+	simulate(sim, time);
+}
+
+void Orbit::simulate(Simulation &state, double time) const {
 	if (p == 0.0) { //degenerate case
-		glm::dvec3 drvel;
-		for (size_t i = 0; i < UpdateSteps; i++) {
-			double f = -mu / (sim.r * sim.r);
-			drvel = time_step * f * (rot * glm::dvec3(
-				std::cos(sim.theta),
-				std::sin(sim.theta),
-				0.0
-			));
-			sim.rpos += (sim.rvel + 0.5 * drvel) * time_step;
-			sim.rvel += drvel;
-			sim.r = glm::l2Norm(sim.rpos);
-			sim.theta = glm::atan(sim.rpos.y, sim.rpos.x);
-		}
+		propagate_universal(state.rpos, state.rvel, time);
+		state.r = glm::l2Norm(state.rpos);
+		state.theta = glm::atan(state.rpos.y, state.rpos.x);
+	} else if (is_near_parabolic()) {
+		propagate_universal(state.rpos, state.rvel, time);
+		state.r = glm::l2Norm(state.rpos);
+		state.theta = anomaly_of(state.rpos, state.theta);
+		state.dtheta = compute_dtheta(state.r);
 	} else { //standard case
-		for (size_t i = 0; i < UpdateSteps; i++) {
-			sim.theta += sim.dtheta * time_step;
-			sim.r = compute_r(sim.theta);
-			sim.dtheta = compute_dtheta(sim.r);
-		}
-		sim.rpos = get_rpos(sim.theta, sim.r);
-		sim.rvel = get_rvel(sim.theta);
+		state.theta = propagate(state.theta, time);
+		state.r = compute_r(state.theta);
+		state.dtheta = compute_dtheta(state.r);
+		state.rpos = get_rpos(state.theta, state.r);
+		state.rvel = get_rvel(state.theta);
 	}
 
-	sim.pos = origin->orbit != nullptr ? sim.rpos + origin->orbit->sim.pos : sim.rpos;
-	sim.vel = origin->orbit != nullptr ? sim.rvel + origin->orbit->sim.vel : sim.rvel;
+	state.time += time;
+}
+
+glm::dvec3 Orbit::predicted_rpos(double time) const {
+	Simulation state = predicted_from;
+	simulate(state, time - state.time);
+	return state.rpos;
 }
 
-void Orbit::find_closest_approach(
-		Orbit const &other, size_t points_idx, size_t other_points_idx, ClosestApproachInfo &closest) {
-	// LOG("start:" << origin->transform->name << " " << other.origin->transform->name << " " << closest.dist);
+double Orbit::mean_anomaly(double theta_) const {
+	//like true_to_mean, but theta_ may wind past +-pi (whole revolutions carry over)
+	if (inv_a > 0.0) {
+		double revs = 2.0 * M_PI * std::round(theta_ / (2.0 * M_PI));
+		return true_to_mean(theta_ - revs) + revs;
+	}
+	return true_to_mean(theta_);
+}
+
+double Orbit::time_until_radius(double theta_, double radius, bool inbound) const {
+	//Kepler orbit equation solved for theta: p / (1 + c cos(theta)) == radius
+	//NOTE: near-parabolic orbits lose too much precision converting anomalies, so are left to the caller
+	if (p == 0.0 || c == 0.0 || is_near_parabolic()) return std::numeric_limits< double >::infinity();
+	double cos_crossing = (p / radius - 1.0) / c;
+	if (cos_crossing < -1.0 || cos_crossing > 1.0) return std::numeric_limits< double >::infinity();
+	if (inbound && compute_r(theta_) <= radius) return 0.0; //already inside
+
+	double crossing = std::acos(cos_crossing); //outbound half of the orbit has theta in [0, pi]
+	if (inbound) crossing = -crossing;
+	if (inv_a > 0.0) { //next time around at or after theta_
+		crossing += 2.0 * M_PI * std::ceil((theta_ - crossing) / (2.0 * M_PI));
+	} else if (theta_ >= crossing) { //open orbit already past it
+		return inbound ? std::numeric_limits< double >::infinity() : 0.0;
+	}
+	return (mean_anomaly(crossing) - mean_anomaly(theta_)) / mean_motion;
+}
+
+bool Orbit::find_encounter(Body const *satellite, Simulation const &start, double step, double &tau) const {
+	//Distance to the satellite's SOI (negative inside) and its rate of change, tau seconds after start
+	auto separation = [&](double tau_, double &gap, double &rate) {
+		Simulation state = start;
+		simulate(state, tau_);
+		glm::dvec3 satellite_rpos, satellite_rvel;
+		satellite->state_at(state.time, satellite_rpos, satellite_rvel);
+		glm::dvec3 dr = state.rpos - satellite_rpos;
+		double dist = glm::l2Norm(dr);
+		gap = dist - satellite->soi_radius;
+		rate = glm::dot(dr, state.rvel - satellite_rvel) / dist;
+	};
+	auto gap_at = [&](double tau_) {
+		double gap, rate;
+		separation(tau_, gap, rate);
+		return gap;
+	};
+	auto rate_at = [&](double tau_) {
+		double gap, rate;
+		separation(tau_, gap, rate);
+		return rate;
+	};
+
+	double gap_start, rate_start;
+	separation(0.0, gap_start, rate_start);
+	if (gap_start <= 0.0) return false; //already inside (e.g. just transferred out of it)
+
+	double gap_end, rate_end;
+	separation(step, gap_end, rate_end);
+	double end = step;
+	if (gap_end > 0.0) {
+		//outside at both ends, but may have dipped into the SOI in between, which needs a closest approach inside the
+		// step, i.e. the range rate going from negative to positive:
+		if (rate_start >= 0.0 || rate_end <= 0.0) return false;
+		end = brent_root(rate_at, 0.0, step, rate_start, rate_end, EncounterTolerance);
+		gap_end = gap_at(end);
+		if (gap_end > 0.0) return false;
+	}
+
+	tau = brent_root(gap_at, 0.0, end, gap_start, gap_end, EncounterTolerance);
+	return true;
+}
+
+void Orbit::find_closest_approach(Orbit const &other, ClosestApproachInfo &closest) const {
+	ClosestSample sample;
+	scan_closest_approach(other, 0, 0, closest, sample);
+	if (sample.orbit == nullptr) return;
+
+	//The true minimum lies between the neighbours of the closest pair of points, so minimize the distance there,
+	// evaluating both trajectories at the same instant:
+	Orbit const &a = *sample.orbit;
+	Orbit const &b = *sample.other;
+	double lo = std::max(a.point_times[sample.i > 0 ? sample.i - 1 : 0], b.point_times[sample.j > 0 ? sample.j - 1 : 0]);
+	double hi = std::min(a.point_times[std::min(sample.i + 1, a.point_times.size() - 1)],
+		b.point_times[std::min(sample.j + 1, b.point_times.size() - 1)]);
+	if (!(lo < hi)) return;
+
+	auto dist2 = [&](double time) {
+		return glm::length2(a.predicted_rpos(time) - b.predicted_rpos(time));
+	};
+	double time = golden_section_min(dist2, lo, hi, ApproachTolerance);
+
+	closest.rocket_rpos = a.predicted_rpos(time);
+	closest.asteroid_rpos = b.predicted_rpos(time);
+	closest.dist = glm::distance(closest.rocket_rpos, closest.asteroid_rpos);
+	closest.time = time;
+	closest.time_diff = 0.0;
+}
+
+void Orbit::scan_closest_approach(Orbit const &other, size_t points_idx, size_t other_points_idx,
+		ClosestApproachInfo &closest, ClosestSample &sample) const {
+	// LOG("start:" << origin->id << " " << other.origin->id << " " << closest.dist);
 
 	//NOTE: only call for rocket
 	size_t ni = points.size();
@@ -825,6 +1081,11 @@ void Orbit::find_closest_approach(
 				closest.asteroid_rpos = pos_j;
 				closest.dist = dist;
 				closest.time_diff = point_times[i] - other.point_times[j];
+				closest.time = point_times[i];
+				sample.orbit = this;
+				sample.other = &other;
+				sample.i = i;
+				sample.j = j;
 			}
 		}
 
@@ -836,63 +1097,66 @@ void Orbit::find_closest_approach(
 		}
 	}
 
-	// LOG("end: " << origin->transform->name << " " << other.origin->transform->name << " " << closest.dist);
+	// LOG("end: " << origin->id << " " << other.origin->id << " " << closest.dist);
 
 	if (i < ni && j < nj && continuation != nullptr && other.continuation != nullptr) {
-		continuation->find_closest_approach(*other.continuation, 0, 0, closest);
+		continuation->scan_closest_approach(*other.continuation, 0, 0, closest, sample);
 	} else if (i < ni && continuation != nullptr) {
-		continuation->find_closest_approach(other, 0, j, closest);
+		continuation->scan_closest_approach(other, 0, j, closest, sample);
 	} else if (j < nj && other.continuation != nullptr) {
-		find_closest_approach(*other.continuation, i, 0, closest);
+		scan_closest_approach(*other.continuation, i, 0, closest, sample);
 	}
 }
 
-double Orbit::find_time_of_collision() {
-	// Call only for asteroid / rocket orbit
-	size_t n = points.size();
-
-	for (size_t i = 0; i < n; i++) {
-		if (points[i] == Orbit::Invalid) break;
+size_t Orbit::point_index(double theta_) const {
+	size_t n = point_thetas.size();
+	if (n == 0) return 0;
+	double front = point_thetas.front();
+	double back = point_thetas.back();
 
-		double dist = glm::l2Norm(points[i]);
-		if (dist < origin->radius) { //collision
-			return point_times[i];
-		}
-	}
-
-	if (continuation != nullptr) {
-		return continuation->find_time_of_collision();
+	if (c < 1.0) { //bring theta_ into the revolution starting at the first point
+		theta_ = front + (theta_ - front) - 2.0 * M_PI * std::floor((theta_ - front) / (2.0 * M_PI));
+		//past the last point: closed paths wrap around to the first, so take whichever end is nearer
+		if (theta_ > back) return (front + 2.0 * M_PI - theta_ < theta_ - back ? 0 : n - 1);
 	} else {
-		return std::numeric_limits< double >::infinity();
+		if (theta_ <= front) return 0;
+		if (theta_ >= back) return n - 1;
 	}
-}
 
-void Orbit::draw(DrawLines &lines, glm::u8vec4 const &color) const {
-	size_t n = points.size();
+	//point_thetas only ever increase along the path, so bisect:
+	size_t i = std::upper_bound(point_thetas.begin(), point_thetas.end(), theta_) - point_thetas.begin();
+	if (i == 0) return 0;
+	if (i == n) return n - 1;
+	return (theta_ - point_thetas[i - 1] < point_thetas[i] - theta_ ? i - 1 : i);
+}
 
-	glm::dvec3 const &origin_pos = origin->pos;
+void Orbit::points_changed() {
+	//NOTE: predictions are made on the Predictor thread as well, so revisions are handed out atomically
+	static std::atomic< uint64_t > next_revision(1);
+	points_revision = next_revision++;
+}
 
-	const glm::dvec3 pos = get_pos();
-	double min_dist = 1e8;
-	size_t start_idx = 0;
-	for (size_t i = 0 ; i < n; i++) {
-		double dist = glm::l2Norm(pos - (origin_pos + points[i]));
-		if (dist < min_dist) {
-			min_dist = dist;
-			start_idx = i;
+double Orbit::find_time_of_collision() const {
+	// Call only for asteroid / rocket orbit
+	if (!points.empty() && p != 0.0 && !is_near_parabolic()) {
+		//r(theta) == radius on the way in, counted only if it comes before this conic hands over to the next
+		double impact = predicted_from.time + time_until_radius(predicted_from.theta, origin->radius, true);
+		if (impact <= soi_transit) return impact;
+	} else { //anomalies unusable, fall back to the first predicted point inside the body
+		size_t n = points.size();
+		for (size_t i = 0; i < n; i++) {
+			if (points[i] == Orbit::Invalid) break;
+
+			double dist = glm::l2Norm(points[i]);
+			if (dist < origin->radius) { //collision
+				return point_times[i];
+			}
 		}
 	}
 
-	// LOG(n << " points");
-	for (size_t i = 0; i < n; i++) {
-		// LOG("drawing " << glm::to_string(points[i-1])  << " to " << glm::to_string(points[i]));
-		glm::dvec3 next = points[(i + 1) % n];
-
-		if (next == Orbit::Invalid || glm::l2Norm(next) > 1e8) break;
-
-		double alpha = color.w * std::max(0.2, static_cast< double >(n - i + start_idx)) / n;
-		lines.draw(points[i] + origin_pos, next + origin_pos, glm::u8vec4(color.x, color.y, color.z, alpha));
+	if (continuation != nullptr) {
+		return continuation->find_time_of_collision();
+	} else {
+		return std::numeric_limits< double >::infinity();
 	}
-
-	if (continuation != nullptr) continuation->draw(lines, color);
 }
@@ -1,14 +1,20 @@
 #pragma once
 
-#include "DrawLines.hpp"
-#include "Scene.hpp"
-#include "Sound.hpp"
+/*
+ * Orbital simulation: bodies, the rocket, the asteroid and the Kepler orbits they follow.
+ *
+ * Builds into liborbit (see Maekfile.js) with no GL/SDL dependencies, so it can run headless. Presentation
+ * (transforms, particles, audio) is attached by the game through its own handles, reading entity state after
+ * each step; drawing is declared here but defined in OrbitalMechanicsDraw.cpp, which only the game links.
+ *
+ */
 
 #define GLM_PRECISION_HIGHP_FLOAT
 #define GLM_PRECISION_HIGHP_DOUBLE
 #include <glm/glm.hpp>
 
 #include <array>
+#include <cstdint>
 #include <iomanip>
 #include <limits>
 #include <list>
@@ -16,14 +22,21 @@
 #include <string>
 #include <vector>
 #include <deque>
+#include <memory>
 
-#include "EmissiveShaderProgram.hpp"
+#include "Ephemeris.hpp"
+#include "NBodyBatch.hpp"
+#include "OrbitBatch.hpp"
 
 extern double universal_time;
 
 //Forward declarations
+struct OrbitLines;
+struct OrbitConics;
+struct DrawBeams;
 struct Body;
 struct Orbit;
+struct Predictor;
 
 enum DilationLevel {
 	LEVEL_0 = 1, //real-time, only permit movement under this level
@@ -36,6 +49,15 @@ enum DilationLevel {
 
 extern DilationLevel dilation;
 
+//On-rails warp: past LEVEL_5, each frame jumps ahead analytically instead of stepping at a fixed rate,
+// easing toward and stopping exactly on the next scheduled event (SOI transition, closest approach, impact)
+extern bool on_rails;
+extern double rails_step; //universal seconds covered by the current frame while on rails
+//Universal seconds that pass over elapsed real seconds, on rails or not
+double dilated(double elapsed);
+//Pick this frame's rails_step toward next_event (universal time); returns true if the frame arrives there
+bool plan_rails_step(double elapsed, double next_event);
+
 DilationLevel operator++(DilationLevel &level, int);
 DilationLevel operator--(DilationLevel &level, int);
 bool operator>(DilationLevel a, DilationLevel b);
@@ -48,6 +70,7 @@ struct Entity {
 	glm::dvec3 pos{0.};
 	glm::dvec3 vel{0.};
 	glm::dvec3 acc{0.};
+	glm::dvec3 prev_pos{0.}; //pos as of the previous simulation step, transforms are drawn in between
 	double radius; //collision radius, Megameters (1000 kilometers)
 	double mass; //mass used for gravity calculation, Gigagrams (1 million kilograms)
 };
@@ -59,10 +82,6 @@ struct Body : public Entity {
     double dayLengthInSeconds = 1.0;
 
 	void set_orbit(Orbit *orbit_);
-	void set_transform(Scene::Transform *transform_)  {
-		transform = transform_;
-		transform->position = pos;
-	}
 	void add_satellite(Body *body) {
 		satellites.emplace_back(body);
 	}
@@ -73,13 +92,21 @@ struct Body : public Entity {
 		return glm::distance(pos, target_pos) <= soi_radius;
 	}
 	void update(double elapsed);
-	void init_sim();
-	void simulate(double time);
-	void draw_orbits(DrawLines &lines, glm::u8vec4 const &color, double scale);
+	//state relative to orbit->origin at (universal) time; reads only what set_orbit captured, so is safe to call
+	// while the body is being updated:
+	void state_at(double time, glm::dvec3 &rpos_, glm::dvec3 &rvel_) const;
+	void draw_orbits(OrbitConics &conics, glm::u8vec4 const &color);
 
 	std::vector< Body * > satellites;
 	Orbit *orbit = nullptr;
-	Scene::Transform *transform = nullptr;
+	double spin = 0.0; //rotation about its own (z) axis, radians
+	Ephemeris ephemeris; //fitted by set_orbit, for use by trajectory prediction
+
+	//orbit state captured by set_orbit, at universal time epoch_time:
+	double epoch_time = 0.0;
+	double epoch_M = 0.0; //mean anomaly
+	glm::dvec3 epoch_rpos{0.};
+	glm::dvec3 epoch_rvel{0.};
 
 	//Fixed values
 	int id;
@@ -96,6 +123,19 @@ struct Particle : public Body {
 
 	double value = id == -1 ? FuelPelletValue : DebrisValue;
 	bool bIsConsumed = false;
+
+	//entry in the batch propagating this particle's orbit (see OrbitBatch), if any:
+	OrbitBatch::Handle batch_handle = OrbitBatch::InvalidHandle;
+	//entry in the batch integrating this particle under every body's gravity instead (see NBodyBatch), if any:
+	NBodyBatch::Handle nbody_handle = NBodyBatch::InvalidHandle;
+	//hand the (already set) orbit to batch, if it is one the batch can propagate:
+	void attach(OrbitBatch &batch);
+	//hand the state on the (already set) orbit to field, which integrates it from then on:
+	void attach(NBodyBatch &field);
+	//like Body::update, but takes the state already advanced by batch.update() or field.update(), whichever has it:
+	void update(double elapsed, OrbitBatch const &batch, NBodyBatch const &field);
+	//field doesn't keep orbit up to date, so fit it to the current state (around the same origin) when it's needed:
+	void refit_orbit();
 };
 
 struct Beam {
@@ -105,6 +145,9 @@ struct Beam {
 	static constexpr double vel = 299.792; // speed of light in megameters/sec
 	static constexpr double MaxStrength = 0.1; // MegaNewtons.
 	//NOTE: 100 kN is roughly weight of 2.5 elephants
+	static constexpr double CollideSlack = 0.1f; // Megameters a hit may add to the path through both ends of the step
+	static constexpr double Falloff = 0.05; // strength is 1 / (1 + Falloff * distance)^2, see inverse_sq
+	static constexpr double MinVisibleStrength = 1.0e-2; // beams fainter than this aren't drawn
 	glm::dvec3 pos;
 	const glm::dvec3 heading; // maybe we can make this change due to gravity of bodies?
 	double dt = 0.;
@@ -112,9 +155,10 @@ struct Beam {
 
 	glm::dvec3 compute_delta_pos() const;
 	bool collide(glm::dvec3 x) const;
+	double reach() const; //collide() only accepts points within this distance of the segment covered this step
 	double get_mass(glm::dvec3 x) const;
 	static double inverse_sq(glm::dvec3 const &x, glm::dvec3 const &start);
-	void draw(DrawLines &DL) const;
+	void draw(DrawBeams &DB) const;
 };
 
 //Closest approach information
@@ -124,13 +168,14 @@ struct ClosestApproachInfo {
 	glm::dvec3 asteroid_rpos; //asteroid position (relative to body it orbits) at closest approach
 	double time_diff = std::numeric_limits< double >::infinity(); //used for debug
 	double dist = std::numeric_limits< double >::infinity();
+	double time = std::numeric_limits< double >::infinity(); //universal time of closest approach
 };
 
 //Asteroid
 struct Asteroid : public Entity {
 	Asteroid(double r_, double m_) : Entity(r_, m_) {}
 
-	void init(Scene::Transform *transform_, Body *root);
+	void init(Body *root);
 	void update(double elapsed, std::deque< Beam > const &lasers);
 	std::string get_time_remaining() {
 		if (time_of_collision == std::numeric_limits< double >::infinity()) {
@@ -143,7 +188,7 @@ struct Asteroid : public Entity {
 
 	Body *root = nullptr;
 	std::list< Orbit > orbits;
-	Scene::Transform *transform;
+	std::shared_ptr< Predictor > predictor; //replans orbits after laser hits/SOI changes in the background
 
 	bool crashed = false;
 	double time_of_collision = 42.0; // dummy init value so we don't start on 0 and trigger win
@@ -153,22 +198,21 @@ struct Asteroid : public Entity {
 struct Rocket : public Entity {
 	Rocket() : Entity(0.2, 0.01) {}
 
-	void init(Scene::Transform *transform_, Body *root, Scene *scene, Asteroid const &asteroid);
+	void init(Body *root, Asteroid const &asteroid);
 
 	void update(double elapsed, Asteroid const &asteroid);
 	void update_lasers(double elapsed);
-	void fire_laser();
+	bool fire_laser(); //returns false while the laser is still recharging
 
 	glm::dvec3 get_heading() const;
 
 	Body *root;
 	std::list< Orbit > orbits;
-	Scene::Transform *transform;
-	std::shared_ptr< Sound::PlayingSample > engine_loop;
+	std::shared_ptr< Predictor > predictor; //replans orbits after thrust/SOI changes in the background
 
 	static double constexpr DryMass = 4.0; // Megagram
 	static double constexpr MaxThrust = 0.05; // MegaNewtons
-	static double constexpr MaxFuelConsumption = 0.00002; // Measured by mass, Megagram
+	static double constexpr MaxFuelConsumption = 0.0012; // Megagram per second per percent of thrust
 	static double constexpr LaserCooldown = 1.0e4;
 
 	static int constexpr MAX_BEAMS = 100; // don't have more than this
@@ -185,24 +229,9 @@ struct Rocket : public Entity {
 	double laser_timer = 0.0; //when 0, laser is fireable
 
 	ClosestApproachInfo closest;
+	double time_of_collision = std::numeric_limits< double >::infinity(); //with whatever it orbits, universal time
 
 	bool crashed = false;
-
-	double timeSinceLastParticle = 0.0;
-	int lastParticle = 0;
-
-	struct ThrustParticle {
-		double lifeTime;
-		glm::dvec3 velocity;
-		double scale;
-		double _t;
-		glm::vec4 color;
-		std::list<Scene::Transform>::iterator transform;
-		ThrustParticle(std::list<Scene::Transform>::iterator trans_, double lifeTime_, glm::dvec3 v_, double scale) : lifeTime(lifeTime_), velocity(v_), scale(scale), transform(trans_) {
-			_t = 0;
-		}
-	};
-	std::vector<ThrustParticle> thrustParticles;
 };
 
 //Keplerian orbital mechanics
@@ -211,7 +240,8 @@ struct Rocket : public Entity {
 //Orbital path: https://en.wikipedia.org/wiki/Kepler_orbit
 //Orbital velocity: https://en.wikipedia.org/wiki/Vis-viva_equation
 struct Orbit {
-	Orbit(Body *origin, glm::dvec3 pos, glm::dvec3 vel, bool simulated, bool verbose = false);
+	//if relative, pos and vel are given relative to origin (otherwise they are world-space):
+	Orbit(Body *origin, glm::dvec3 pos, glm::dvec3 vel, bool relative, bool verbose = false);
 	Orbit(Body *origin_, double c_, double p_, double phi_, double theta_, bool retrograde, bool verbose = false);
 
 	void init_dynamics() {
@@ -223,14 +253,14 @@ struct Orbit {
 	}
 
 	// Computing dynamics
-	double compute_dtheta(double r_) {
+	double compute_dtheta(double r_) const {
 		//vis-viva equation: https://en.wikipedia.org/wiki/Vis-viva_equation
 		return std::sqrt(mu * (2.0 / r_ - inv_a)) / r_;
 	}
 	double compute_dtheta() {
 		return dtheta = compute_dtheta(r);
 	}
-	double compute_r(double theta_) {
+	double compute_r(double theta_) const {
 		//Kepler orbit equation: https://en.wikipedia.org/wiki/Kepler_orbit
 		double denom = (1.0 + c * std::cos(theta_));
 		return denom != 0.0 ? p / denom : p;
@@ -238,9 +268,21 @@ struct Orbit {
 	double compute_r() {
 		return r = compute_r(theta);
 	}
+	void compute_mean_motion();
+	double true_to_mean(double theta_) const;
+	double mean_to_true(double M) const;
+	double propagate(double theta_, double time) const;
+	double mean_anomaly(double theta_) const;
+	//Time from theta_ until the orbit reaches radius, on the way out (or in, for inbound); infinity if it never does
+	double time_until_radius(double theta_, double radius, bool inbound = false) const;
+	void propagate_universal(glm::dvec3 &rpos_, glm::dvec3 &rvel_, double time) const;
+	double anomaly_of(glm::dvec3 const &rpos_, double theta_) const;
+	bool is_near_parabolic() const {
+		return std::abs(c - 1.0) < NearParabolic;
+	}
 	void update(double elapsed);
-	glm::dvec3 get_rpos(double theta_, double r_);
-	glm::dvec3 get_rvel(double theta_);
+	glm::dvec3 get_rpos(double theta_, double r_) const;
+	glm::dvec3 get_rvel(double theta_) const;
 
 	//Convenience functions
 	glm::dvec3 get_pos() const {
@@ -251,35 +293,60 @@ struct Orbit {
 	}
 
 	//Simulate and draw the orbit (populate points)
-	void predict();
-	void init_sim();
+	double sample_arc(double r_) const; //arc length between points at distance r_, see PredictTurn/PredictChordError
+	void init_sim(double time);
 	void simulate(double time);
-	void sim_predict(
-		Body *root, std::list< Orbit > &orbits, int level, std::list< Orbit >::iterator it, double start_time);
+	void sim_predict(std::list< Orbit > &orbits, int level, std::list< Orbit >::iterator it, double start_time);
+	//Move the predicted trajectory over from another orbit (e.g. to keep showing it while a new one is computed);
+	// soi_transit and continuation come along too, until sim_predict() resets them for the new path:
+	void take_prediction(Orbit &from);
+	//Drop the predicted trajectory (e.g. after changing origin, when the old points no longer apply)
+	void clear_prediction() {
+		points.clear();
+		point_times.clear();
+		point_thetas.clear();
+		points_changed();
+		soi_transit = std::numeric_limits< double >::infinity();
+		continuation = nullptr;
+	}
 	bool will_soi_transit(double elapsed)  {
-		return theta + 32.0f * dtheta * elapsed * static_cast< double >(dilation) >= soi_transit;
+		return universal_time + dilated(elapsed) >= soi_transit;
 	}
-	void find_closest_approach(Orbit const &other, size_t points_idx, size_t other_points_idx,
-		ClosestApproachInfo &closest);
-	double find_time_of_collision();
-	void draw(DrawLines &lines, glm::u8vec4 const &color) const;
+	//Closest approach between this chain and other's, found on the points then refined on the conics themselves:
+	void find_closest_approach(Orbit const &other, ClosestApproachInfo &closest) const;
+	//Universal time the chain first reaches its origin's surface, solved on each conic up to its SOI transition
+	double find_time_of_collision() const;
+	//Index of the point nearest true anomaly theta_ along the predicted path (wrapping around closed orbits)
+	size_t point_index(double theta_) const;
+	//Note that points have been replaced, so anything cached from them (e.g. GPU copies) is out of date
+	void points_changed();
+	void draw(OrbitLines &lines, glm::u8vec4 const &color) const;
 
 	//Constants
 	static double constexpr G = 6.67430e-23; //Standard gravitational constant
 	static double constexpr MinPForDegen = 1.0e-4;
-	static size_t constexpr UpdateSteps = 100;
-	static size_t constexpr PredictDetail = 900; //number of points to generate when predicting
-	static double constexpr PredictAngle = glm::radians(360.0 / static_cast< double >(PredictDetail)); //change btwn pts
+	static double constexpr NearParabolic = 1.0e-5; //eccentricity band propagated with universal variables
+	static double constexpr KeplerTolerance = 1.0e-12; //convergence threshold for Kepler's equation, radians
+	static int constexpr KeplerMaxIterations = 16;
+	static size_t constexpr MaxPredictPoints = 900; //hard cap on points generated per orbit when predicting
+	static double constexpr PredictTurn = glm::radians(3.0); //max change in direction of travel between points
+	static double constexpr PredictChordError = 5.0e-4; //max distance between path and chord, relative to r
 	static double constexpr TimeStep = 1.0; //time step, seconds
 	static glm::dvec3 constexpr Invalid = glm::dvec3(std::numeric_limits< double >::max()); // signifies point outside SOI
 	static int constexpr MaxLevel = 2;
+	static double constexpr EncounterTolerance = 1.0e-3; //how precisely SOI transition times are found, seconds
+	static double constexpr ApproachTolerance = 1.0e-3; //how precisely closest approach times are found, seconds
 	//Fixed values
 	Body *origin;
 
-	//Future trajectory, populated by predict()
-	std::array< glm::dvec3, PredictDetail > points; //Cache of orbit points for drawing
-	std::array< double, PredictDetail > point_times; //Used only for Rocket/Asteroid closest approach calc
-	double soi_transit = std::numeric_limits< double >::infinity(); //theta value for SOI transit
+	//Future trajectory, populated by sim_predict() on the Predictor worker (see Predictor.hpp)
+	//Points are spaced by curvature, so there are many around periapsis and few along gentle stretches
+	//A closed orbit's points cover exactly one revolution; otherwise the path ends in an Invalid point
+	std::vector< glm::dvec3 > points; //Cache of orbit points for drawing
+	std::vector< double > point_times; //Used only for Rocket/Asteroid closest approach calc
+	std::vector< double > point_thetas; //True anomaly of each point, unwrapped, so it only increases along the path
+	uint64_t points_revision = 0; //Changes whenever points do (and is unique to those points), see points_changed()
+	double soi_transit = std::numeric_limits< double >::infinity(); //universal time of SOI transit
 	Orbit *continuation = nullptr; //Continuation in next SOI
 
 	//Values defining orbit
@@ -293,6 +360,7 @@ struct Orbit {
 	double mu; //standard gravitation parameter, mu = G * origin->mass;
 	double mu_over_h; //=mu/h, h is magnitude of specific orbital angular momentum
 	double inv_a; //=1/a
+	double mean_motion; //rate of change of mean anomaly, radians/second
 	glm::dmat3 rot; //rotation matrix from orbital plane to world
 
 	//Dynamics
@@ -305,15 +373,31 @@ struct Orbit {
 
 	//Dynamics under simulation
 	struct Simulation {
-		double r;
-		double theta;
-		double dtheta;
-		glm::dvec3 pos;
-		glm::dvec3 vel;
-
-		glm::dvec3 rpos;
-		glm::dvec3 rvel;
+		double r = 0.0;
+		double theta = 0.0;
+		double dtheta = 0.0;
+		double time = 0.0; //universal time
+
+		glm::dvec3 rpos{0.};
+		glm::dvec3 rvel{0.};
 	};
 
 	Simulation sim;
+	Simulation predicted_from; //state at point_times[0], which the points were predicted from
+
+	//Advance a copy of simulated state by time (simulate(time) advances sim):
+	void simulate(Simulation &state, double time) const;
+	//Position along the predicted trajectory at (universal) time, in closed form rather than from the points:
+	glm::dvec3 predicted_rpos(double time) const;
+
+	//Pair of points find_closest_approach() refines from:
+	struct ClosestSample {
+		Orbit const *orbit = nullptr;
+		Orbit const *other = nullptr;
+		size_t i = 0, j = 0;
+	};
+	void scan_closest_approach(Orbit const &other, size_t points_idx, size_t other_points_idx,
+		ClosestApproachInfo &closest, ClosestSample &sample) const;
+	//Search the step seconds after start for entry into satellite's SOI, setting tau to the time of entry:
+	bool find_encounter(Body const *satellite, Simulation const &start, double step, double &tau) const;
 };
@@ -0,0 +1,42 @@
+#include "OrbitalMechanics.hpp"
+#include "OrbitLines.hpp"
+#include "OrbitConics.hpp"
+#include "DrawBeams.hpp"
+
+#include <glm/gtx/norm.hpp>
+
+#include <cassert>
+
+//Drawing for the orbital simulation, kept apart from OrbitalMechanics.cpp so the simulation itself (liborbit) has
+// no GL dependency and can run headless.
+
+void Body::draw_orbits(OrbitConics &conics, glm::u8vec4 const &color) {
+	//drawn from the elements, so there's no need to limit how many are shown (bodies' orbits are all closed)
+	if (orbit != nullptr) conics.draw(*orbit, color);
+
+	for (Body *body : satellites) {
+		assert(body != nullptr);
+		if (body->id >= 0)
+			body->draw_orbits(conics, color);
+	}
+}
+
+void Beam::draw(DrawBeams &DB) const {
+	// drawing one timestep "ago" since the time dilation makes it really fast
+	// ==> so that we always see the start of the beam at the rocket
+	// "mass" equates to beam strength which dissipates over time (opacity), evaluated per fragment from the
+	// distance to start_pos (which is linear along the beam, as start_pos lies behind it on the same line)
+	const glm::dvec3 start = pos - compute_delta_pos();
+	const glm::dvec3 &end = pos;
+	if (get_mass(start) < MinVisibleStrength) return; //faded out entirely
+
+	DB.draw(start, end, static_cast< float >(glm::l2Norm(start - start_pos)),
+		static_cast< float >(glm::l2Norm(end - start_pos)), col);
+}
+
+void Orbit::draw(OrbitLines &lines, glm::u8vec4 const &color) const {
+	//points are kept on the GPU by lines, and faded from the one nearest theta (see OrbitLineProgram):
+	lines.draw(*this, color);
+
+	if (continuation != nullptr) continuation->draw(lines, color);
+}
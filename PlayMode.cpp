@@ -2,12 +2,19 @@
 #include "EmissiveShaderProgram.hpp"
 #include "GL.hpp"
 #include "LitColorTextureProgram.hpp"
+#include "LitColorInstancedProgram.hpp"
 #include "FrameQuadProgram.hpp"
 #include "BloomBlurProgram.hpp"
 #include "OrbitalMechanics.hpp"
+#include "Predictor.hpp"
+#include "UniformBlocks.hpp"
+#include "Frustum.hpp"
 #include "Utils.hpp"
 
 #include "DrawLines.hpp"
+#include "OrbitLines.hpp"
+#include "OrbitConics.hpp"
+#include "DrawBeams.hpp"
 #include "Load.hpp"
 #include "Scene.hpp"
 #include "gl_errors.hpp"
@@ -64,6 +71,17 @@ Load< Sound::Sample > bgm(LoadTagDefault, []() -> Sound::Sample const * {
 	return new Sound::Sample(data_path("assets/sound/bgm.wav"));
 });
 
+Load< MeshBuffer > particle_meshes(LoadTagDefault, []() -> MeshBuffer const * {
+	return new MeshBuffer(data_path("assets/model/particles.pnct"));
+});
+
+Load< Sound::Sample > laser_sfx(LoadTagDefault, []() -> Sound::Sample const * {
+	return new Sound::Sample(data_path("assets/sound/laser.wav"));
+});
+Load< Sound::Sample > engine_sfx(LoadTagDefault, []() -> Sound::Sample const * {
+	return new Sound::Sample(data_path("assets/sound/engine.wav"));
+});
+
 void PlayMode::SetupFramebuffers(){
 	 // configure (floating point) framebuffers
     // ---------------------------------------
@@ -177,6 +195,9 @@ PlayMode::PlayMode() : scene(*orbit_scene) {
 }
 
 PlayMode::~PlayMode() {
+	//predictions read bodies, which are destroyed before the rocket and asteroid
+	if (spaceship.predictor) spaceship.predictor->cancel();
+	if (asteroid.predictor) asteroid.predictor->cancel();
     HUD::freeSprites();
 }
 
@@ -189,17 +210,14 @@ void PlayMode::serialize(std::string const &filename) {
 	file << std::setprecision(16);
 
 	for (auto &body : bodies) {
-		serialize_body(file, body);
+		serialize_body(file, body, entity_transforms.at(&body)->name);
 		file << '\n';
 	}
 
-	for (auto &pellet : fuel_pellets) {
-		serialize_body(file, pellet);
-		file << '\n';
-	}
-
-	for (auto &pellet : debris_pellets) {
-		serialize_body(file, pellet);
+	//N-body pellets have drifted off their conics, so save the conic they are on now (around the same origin):
+	for (auto &pellet : pellets) {
+		pellet.particle.refit_orbit();
+		serialize_body(file, pellet.particle, pellet.transform->name);
 		file << '\n';
 	}
 
@@ -219,12 +237,12 @@ void PlayMode::serialize_orbit(std::ofstream &file, Orbit const &orbit) {
 	 * Orbit: origin_id;c,p,phi,theta,retrograde
 	 * ---
 	 */
-	assert(orbit.origin != nullptr && orbit.origin->transform != nullptr);
+	assert(orbit.origin != nullptr);
 	file << "Orbit: " << orbit.origin->id << ';';
 	file << orbit.c << ',' << orbit.p << ',' << orbit.phi << ',' << orbit.theta << ',' << (orbit.incl != 0.0f) << '\n';
 }
 
-void PlayMode::serialize_body(std::ofstream &file, Body const &body) {
+void PlayMode::serialize_body(std::ofstream &file, Body const &body, std::string const &transform_name) {
 	/**
 	 * Format is:
 	 * ---
@@ -235,8 +253,7 @@ void PlayMode::serialize_body(std::ofstream &file, Body const &body) {
 	 * ---
 	 * For the star, which has no orbit, will have "Orbit: None" instead.
 	 */
-	assert(body.transform != nullptr);
-	file << "Body:\n" << body.transform->name << ',' << body.id << '\n';
+	file << "Body:\n" << transform_name << ',' << body.id << '\n';
 	file << body.radius << ',' << body.mass << ',' << body.soi_radius << "," << body.dayLengthInSeconds << '\n';
 	if (body.orbit == nullptr) {
 		file << "Orbit: None\n";
@@ -257,8 +274,8 @@ void PlayMode::serialize_asteroid(std::ofstream &file) {
 	 * Note that only the primary orbit is serialized. Continuations are not stored at the moment and recalculated on
 	 * init.
 	 */
-	assert(asteroid.transform != nullptr);
-	file << "Asteroid:\n" << asteroid.transform->name << '\n';
+	assert(entity_transforms.count(&asteroid));
+	file << "Asteroid:\n" << entity_transforms.at(&asteroid)->name << '\n';
 	file << asteroid.radius << ',' << asteroid.mass << '\n';
 
 	assert(asteroid.orbits.size() > 0);
@@ -276,8 +293,8 @@ void PlayMode::serialize_rocket(std::ofstream &file) {
 	 * Note that only the primary orbit is serialized. Continuations are not stored at the moment and recalculated on
 	 * init.
 	 */
-	assert(spaceship.transform != nullptr);
-	file << "Rocket:\n" << spaceship.transform->name << '\n';
+	assert(entity_transforms.count(&spaceship));
+	file << "Rocket:\n" << entity_transforms.at(&spaceship)->name << '\n';
 	file << spaceship.theta << ',' << spaceship.fuel << ',' << spaceship.laser_timer << '\n';
 	assert(spaceship.orbits.size() > 0);
 	serialize_orbit(file, spaceship.orbits.front());
@@ -290,17 +307,25 @@ void PlayMode::deserialize(std::string const &filename) {
 	}
 
 	//reset
+	if (spaceship.predictor) spaceship.predictor->cancel();
+	if (asteroid.predictor) asteroid.predictor->cancel();
 	star = nullptr;
 	bodies.clear();
 	orbits.clear();
 	entities.clear();
-	fuel_pellets.clear();
+	entity_transforms.clear();
+	pellets.clear();
 	id_to_body.clear();
 	camera_arms.clear();
 	scene.drawables.clear();
-	fuel_pellets.clear();
-	debris_pellets.clear();
+	pellet_orbits.clear();
+	pellet_field.clear();
+	pellets_on_conics = false;
+	pellet_hash.clear();
+	lock_target(nullptr);
 	dilation = LEVEL_0;
+	on_rails = false;
+	sim_accumulator = 0.0;
 
 	entities.push_back(&spaceship);
 	current_focus_entity = &spaceship; // first focus should be on spaceship
@@ -325,9 +350,19 @@ void PlayMode::deserialize(std::string const &filename) {
 
 	file.close();
 
+	for (Body const &body : bodies) { //N-body pellets feel every body
+		pellet_field.add_source(&body);
+	}
+
 	// track order of focus points for camera
-	for (const Entity *entity : entities) {
-		camera_arms.insert({entity, CameraArm(entity)});
+	for (Entity *entity : entities) {
+		entity->prev_pos = entity->pos; // nothing to interpolate from yet
+		auto found = entity_transforms.find(entity);
+		camera_arms.insert({entity, CameraArm(entity, found != entity_transforms.end() ? found->second : nullptr)});
+	}
+	for (Pellet &pellet : pellets) {
+		pellet.particle.prev_pos = pellet.particle.pos;
+		camera_arms.insert({&pellet.particle, CameraArm(&pellet.particle, pellet.transform)});
 	}
 
 
@@ -441,40 +476,36 @@ void PlayMode::deserialize_body(std::ifstream &file) {
 	}
 
 	if (id == -1) { // fuel pellet
-		fuel_pellets.emplace_back(-1, radius);
-		Particle &pellet = fuel_pellets.back();
+		pellets.emplace(-1, radius);
+		Particle &pellet = pellets.back().particle;
 		pellet.dayLengthInSeconds = dayLengthInSeconds;
-		entities.push_back(&pellet);
 
 		throw_on_err(std::getline(file, line),
 		"Malformed save file: body - not enough lines.");
 		deserialize_orbit(line, orbits);
 		Orbit *orbit = &orbits.back();
 		pellet.set_orbit(orbit);
-		pellet.set_transform(trans);
-
-		Scene::make_drawable(scene, trans, main_meshes.value);
+		attach_transform(pellets.back(), trans);
+		attach_pellet(pellet);
 
-		LOG("Loaded Particle #" << fuel_pellets.size());
+		LOG("Loaded Particle #" << pellets.size());
 		return;
 	}
 
 	if (id == -2) { // debris pellet
-		debris_pellets.emplace_back(-2, radius);
-		Particle &pellet = debris_pellets.back();
+		pellets.emplace(-2, radius);
+		Particle &pellet = pellets.back().particle;
 		pellet.dayLengthInSeconds = dayLengthInSeconds;
-		entities.push_back(&pellet);
 
 		throw_on_err(std::getline(file, line),
 		"Malformed save file: body - not enough lines.");
 		deserialize_orbit(line, orbits);
 		Orbit *orbit = &orbits.back();
 		pellet.set_orbit(orbit);
-		pellet.set_transform(trans);
-
-		Scene::make_drawable(scene, trans, main_meshes.value);
+		attach_transform(pellets.back(), trans);
+		attach_pellet(pellet);
 
-		LOG("Loaded Particle #" << debris_pellets.size());
+		LOG("Loaded Particle #" << pellets.size());
 		return;
 	}
 
@@ -489,7 +520,7 @@ void PlayMode::deserialize_body(std::ifstream &file) {
 		"Malformed save file: body - not enough lines.");
 	if (line == "Orbit: None") { //star
 		//set transform
-		body.set_transform(trans);
+		attach_transform(body, trans);
 
 		//set star pointer
 		star = &body;
@@ -507,7 +538,7 @@ void PlayMode::deserialize_body(std::ifstream &file) {
 		body.set_orbit(orbit);
 
 		//set transform
-		body.set_transform(trans);
+		attach_transform(body, trans);
 
 		//add to origin satellites
 		orbit->origin->add_satellite(&body);
@@ -578,8 +609,11 @@ void PlayMode::deserialize_asteroid(std::ifstream &file) {
 		deserialize_orbit(line, asteroid.orbits);
 	}
 
+	asteroid.init(star);
+
 	//set transform
-	asteroid.init(trans, star);
+	trans->scale = glm::dvec3(asteroid.radius);
+	attach_transform(asteroid, trans);
 
 	//make drawable
 	Scene::make_drawable(scene, trans, main_meshes.value);
@@ -591,13 +625,12 @@ void PlayMode::deserialize_asteroid(std::ifstream &file) {
 
 		for (size_t i = 0; i < fuel_particle_count; i++) {
 			double food_radius = 1.0;
-			fuel_pellets.emplace_back(-1, food_radius);
-			Particle &food = fuel_pellets.back();
+			pellets.emplace(-1, food_radius);
+			Particle &food = pellets.back().particle;
 			scene.transforms.emplace_back();
 			Scene::Transform *fuel_trans = &scene.transforms.back();
 			fuel_trans->name = "FuelParticle"; // simple orange mush
 			fuel_trans->scale = glm::dvec3(food_radius); // very small!
-			Scene::make_drawable(scene, fuel_trans, main_meshes.value);
 			// orbit eccentricity
 			double c = std::min(orbit.c * random_factor(0.05), 0.99);
 			// orbit "radius" scale
@@ -607,22 +640,21 @@ void PlayMode::deserialize_asteroid(std::ifstream &file) {
 			double theta = orbit.theta +  (2 * M_PI * random_factor(0.3));
 			double retrograde = orbit.incl != 0.0;
 			auto *food_orb = new Orbit(orbit.origin, c, p, phi, theta, retrograde);
-			food.set_transform(fuel_trans);
 			food.set_orbit(food_orb);
+			attach_transform(pellets.back(), fuel_trans);
+			attach_pellet(food);
 			food.dayLengthInSeconds = 100.f;
-			entities.push_back(&food);
 		}
 		LOG("loaded " << fuel_particle_count << " fuel pellets");
 
 		for (size_t i = 0; i < debris_particle_count; i++) {
 			double debris_radius = 1.0;
-			debris_pellets.emplace_back(-2, debris_radius);
-			Particle &debris = debris_pellets.back();
+			pellets.emplace(-2, debris_radius);
+			Particle &debris = pellets.back().particle;
 			scene.transforms.emplace_back();
 			Scene::Transform *fuel_trans = &scene.transforms.back();
 			fuel_trans->name = "DebrisParticle"; // simple grey mush
 			fuel_trans->scale = glm::dvec3(2 * debris_radius); // very small!
-			Scene::make_drawable(scene, fuel_trans, main_meshes.value);
 			// orbit eccentricity
 			double c = std::min(orbit.c * random_factor(0.05), 0.99);
 			// orbit "radius" scale
@@ -632,10 +664,10 @@ void PlayMode::deserialize_asteroid(std::ifstream &file) {
 			double theta = orbit.theta +  (2 * M_PI * random_factor(0.1));
 			double retrograde = orbit.incl != 0.0;
 			auto *food_orb = new Orbit(orbit.origin, c, p, phi, theta, retrograde);
-			debris.set_transform(fuel_trans);
 			debris.set_orbit(food_orb);
+			attach_transform(pellets.back(), fuel_trans);
+			attach_pellet(debris);
 			debris.dayLengthInSeconds = 100.f;
-			entities.push_back(&debris);
 		}
 		LOG("loaded " << debris_particle_count << " debris pellets");
 	}
@@ -694,8 +726,15 @@ void PlayMode::deserialize_rocket(std::ifstream &file) {
 		deserialize_orbit(line, spaceship.orbits);
 	}
 
+	spaceship.init(star, asteroid);
+
 	//set transform
-	spaceship.init(trans, star, &scene, asteroid);
+	trans->scale = glm::dvec3(spaceship.radius);
+	attach_transform(spaceship, trans);
+	init_thrust_particles();
+
+	if (engine_loop) engine_loop->stop();
+	engine_loop = Sound::loop(*engine_sfx, static_cast< float >(spaceship.thrust_percent) / 100.0f, 0.0f);
 
 	//make drawable
 	Scene::make_drawable(scene, trans, main_meshes.value);
@@ -772,6 +811,12 @@ void PlayMode::read_params() {
 			debris_particle_count = deserialize_size_t(str);
 		} else if (assigns("text_speed", line)) {
 			text_anim_speed = deserialize_float(str);
+		} else if (assigns("nbody_pellets", line)) {
+			bNBodyPellets = deserialize_bool(str);
+		} else if (assigns("tick_rate", line)) {
+			sim_tick = 1.0 / std::max(deserialize_float(str), 1.0f);
+		} else if (assigns("max_catch_up_ticks", line)) {
+			max_catch_up_ticks = static_cast< uint32_t >(std::max(deserialize_size_t(str), size_t(1)));
 		} else {
 			throw std::runtime_error("Malformed params file. Unknown '" + line + "'.");
 		}
@@ -783,7 +828,7 @@ void PlayMode::read_params() {
 
 void PlayMode::exit_to_menu() {
 	SDL_SetRelativeMouseMode(SDL_FALSE);
-	spaceship.engine_loop->set_volume(0.f); // turn off (continuous) engine noises!
+	engine_loop->set_volume(0.f); // turn off (continuous) engine noises!
 	bLevelLoaded = false; // reload level on menu
 	bIsTutorial = false;
 	game_status = GameStatus::PLAYING; // reset game status on menu
@@ -873,8 +918,6 @@ bool PlayMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size)
 }
 
 void PlayMode::update(float elapsed) {
-	double sim_elapsed = std::min(static_cast< double >(elapsed), MaxSimElapsed);
-
 	if (!bLevelLoaded) {
 		bLevelLaunched = bLevelLoaded;
 		bLevelLoaded = true;
@@ -953,9 +996,11 @@ void PlayMode::update(float elapsed) {
 
 	if (playing) { //update dilation
 		if (plus.downs > 0 && minus.downs == 0) {
+			on_rails = (dilation == LEVEL_5); //going past the top level switches to rails
 			dilation++;
 		} else if (minus.downs > 0 && plus.downs == 0) {
-			dilation--;
+			if (on_rails) on_rails = false;
+			else dilation--;
 		}
 	}
 
@@ -963,6 +1008,7 @@ void PlayMode::update(float elapsed) {
 		{ // reset dilation on controls
 			if (up.downs || down.downs ||  shift.downs || control.downs) {
 				dilation = LEVEL_0; // reset time so user inputs are used
+				on_rails = false;
 			}
 		}
 
@@ -1036,7 +1082,7 @@ void PlayMode::update(float elapsed) {
         }else{
 		    ThrottleReading.set_text("MAX");
         }
-		SpeedupReading.set_text(std::to_string(dilation));
+		SpeedupReading.set_text(on_rails ? "RAILS" : std::to_string(dilation));
 		CollisionHeader.set_static_text("Time to Impact");
 		CollisionTimer.set_text(asteroid.get_time_remaining());
 
@@ -1053,79 +1099,28 @@ void PlayMode::update(float elapsed) {
 		Sound::listener.set_position_right(frame_at, frame_right, 1.0f / 60.0f);
 	}
 
-	if (playing) { //orbital simulation
-		star->update(sim_elapsed);
-		asteroid.update(sim_elapsed, spaceship.lasers);
-		spaceship.update(sim_elapsed, asteroid);
-
-		{ // fuel pellet simulation
-			std::vector<std::list<Particle>::iterator> consumed_pellets = {};
-			for (std::list<Particle>::iterator it = fuel_pellets.begin(); it != fuel_pellets.end(); it++) {
-				it->update(sim_elapsed);
-				if (laser_power > laser_closeness_for_particles // distance threshold
-						&& target_lock != nullptr && target_lock == &(*it)) { // only for aimed particle
-					const Beam *beam = nullptr;
-					for (auto &laser : spaceship.lasers) {
-						if (laser.collide(it->pos)) {
-							beam = &laser;
-							break;
-						}
-					}
-					if (beam == nullptr) continue;
-
-					{ // update fuel
-						spaceship.fuel += it->value;
-						spaceship.fuel = std::min(std::max(spaceship.fuel, 0.0), spaceship.maxFuel);
-					}
-					it->pos = glm::dvec3(0.0);
-					it->transform->position = glm::vec3(0.0);
-					consumed_pellets.push_back(it);
-				}
-			}
-			for (auto it : consumed_pellets) {
-				entities.remove(&(*it));
-				fuel_pellets.erase(it);
-			}
-		}
-
-		{ // debris pellet simulation
-			std::vector<std::list<Particle>::iterator> consumed_debris = {};
-			for (std::list<Particle>::iterator it = debris_pellets.begin(); it != debris_pellets.end(); it++) {
-				it->update(sim_elapsed);
-				if (glm::distance2(spaceship.pos, it->pos) > it->radius * it->radius) continue;
-
-				spaceship.fuel += it->value;
-				spaceship.fuel = std::min(std::max(spaceship.fuel, 0.0), spaceship.maxFuel);
-
-				it->pos = glm::dvec3(0.0);
-				it->transform->position = glm::vec3(0.0);
-				consumed_debris.push_back(it);
-			}
-			for (auto it : consumed_debris) {
-				entities.remove(&(*it));
-				debris_pellets.erase(it);
-			}
+	if (playing && !bIsTutorial) { //laser
+		if (space.pressed && spaceship.fire_laser()) {
+			Sound::play(*laser_sfx, 0.5, 0.0);
 		}
 	}
 
-	if (playing) { // collision logic
-		if (asteroid.crashed) {
-			target_lock = &asteroid;
-			tab.downs = 1; // to trigger the camera transition
-			game_status = GameStatus::LOSE;
-			dilation = LEVEL_0;
-		}
-		else if (spaceship.crashed) {
-			target_lock = &spaceship;
-			tab.downs = 1; // to trigger the camera transition
-			game_status = GameStatus::LOSE;
-			dilation = LEVEL_0;
-		} else if (asteroid.time_of_collision == std::numeric_limits< float >::infinity()) {
-			target_lock = &spaceship;
-			tab.downs = 1; // to trigger the camera transition
-			game_status = GameStatus::WIN;
-			dilation = LEVEL_0;
+	{ //fixed-step simulation: run as many ticks as real time allows, then draw in between the last two
+		sim_accumulator += elapsed;
+		uint32_t ticks = 0;
+		while (sim_accumulator >= sim_tick && game_status == GameStatus::PLAYING) {
+			if (ticks == max_catch_up_ticks) { //too far behind, drop the backlog rather than fall further behind
+				sim_accumulator = std::fmod(sim_accumulator, sim_tick);
+				break;
+			}
+			for_each_entity([](Entity &entity) {
+				entity.prev_pos = entity.pos;
+			});
+			tick(sim_tick, laser_power);
+			sim_accumulator -= sim_tick;
+			ticks++;
 		}
+		interpolate_transforms(game_status == GameStatus::PLAYING ? sim_accumulator / sim_tick : 1.0);
 	}
 
 	if (!playing) { // post-game logic
@@ -1136,14 +1131,6 @@ void PlayMode::update(float elapsed) {
 		}
 	}
 
-	if (playing && !bIsTutorial) { //laser
-		if (space.pressed) {
-			spaceship.fire_laser();
-		}
-
-		spaceship.update_lasers(sim_elapsed);
-	}
-
 	{ //update camera controls (after spaceship update for smooth motion)
 		auto update_camera_pan = [&](){ // compute camera offset according to mouse
 			if (can_pan_camera) {
@@ -1163,10 +1150,10 @@ void PlayMode::update(float elapsed) {
 		glm::vec3 target_pt = camarm.get_target_point(); // where the camera actually goes (not in the center)
 		if (tilde.downs > 0) { // automatically go back to spaceship
 			tab.downs = 1;
-			target_lock = &spaceship;
+			lock_target(&spaceship);
 		}
-		if (tab.downs > 0 && target_lock != nullptr) { // to switch camera views
-			current_focus_entity = target_lock;
+		if (tab.downs > 0 && target_lock() != nullptr) { // to switch camera views
+			current_focus_entity = target_lock();
 			// start the camera transition (new current camera arm)
 			auto &camarm2 = camera_arms.at(current_focus_entity);
 			target_pt = camarm2.get_target_point();
@@ -1219,19 +1206,27 @@ void PlayMode::update(float elapsed) {
 		float min_dist = std::numeric_limits<float>::max(); // infinity
 		glm::vec2 homing_reticle_pos = reticle_aim;
 		glm::vec3 homing_target{0.f, 0.f, 0.f};
-		target_lock = nullptr;
-		for (const Entity *entity : entities) {
-			if (!camera->in_view(entity->pos))
-				continue; // can't focus on offscreen elements
-			glm::vec3 pos3d = glm::vec3(world_to_screen * glm::vec4(entity->pos, 1.0f));
+		lock_target(nullptr);
+		//whether entity is closer to the reticle than anything so far:
+		auto homes_on = [&](Entity const &entity) {
+			if (!camera->in_view(entity.pos))
+				return false; // can't focus on offscreen elements
+			glm::vec3 pos3d = glm::vec3(world_to_screen * glm::vec4(entity.pos, 1.0f));
 			glm::vec2 pos2d{(pos3d.x / pos3d.z), (pos3d.y / pos3d.z)};
 			float ss_dist = glm::length(reticle_aim - pos2d); // screen-space distance (for comparisons)
 			if (ss_dist < homing_threshold && ss_dist < min_dist) {
 				min_dist = ss_dist;
 				homing_reticle_pos = pos2d;
-				homing_target = entity->pos;
-				target_lock = entity;
+				homing_target = entity.pos;
+				return true;
 			}
+			return false;
+		};
+		for (Entity const *entity : entities) {
+			if (homes_on(*entity)) lock_target(entity);
+		}
+		for (size_t i = 0; i < pellets.size(); ++i) {
+			if (homes_on(pellets[i].particle)) lock_target(pellets.handle_at(i));
 		}
 		reticle_homing = (homing_reticle_pos != reticle_aim); // whether or not we locked onto a target
 		reticle_aim = homing_reticle_pos * 0.5f + 0.5f; // [-1:1]^2 -> [0:1]^2
@@ -1272,6 +1267,263 @@ void PlayMode::update(float elapsed) {
 	mouse_motion_rel = glm::vec2(0, 0);
 }
 
+//pellet handles as the hash's ids, and back:
+inline static SpatialHash::Id hash_id(PlayMode::PelletHandle handle) {
+	return (SpatialHash::Id(handle.slot) << 32) | handle.generation;
+}
+inline static PlayMode::PelletHandle pellet_handle(SpatialHash::Id id) {
+	return PlayMode::PelletHandle{ uint32_t(id >> 32), uint32_t(id) };
+}
+
+void PlayMode::tick(double dt, int laser_power) {
+	bool playing = (game_status == GameStatus::PLAYING);
+
+	bool rails_arrived = false;
+	if (playing && on_rails) { //pick this tick's warp step
+		if (!spaceship.predictor->settled() || !asteroid.predictor->settled()) {
+			//events aren't known until the predictions catch up, so hold at the top level meanwhile
+			rails_step = dt * static_cast< double >(dilation);
+		} else {
+			double next_event = std::min({
+				spaceship.orbits.front().soi_transit,
+				asteroid.orbits.front().soi_transit,
+				spaceship.time_of_collision,
+				asteroid.time_of_collision,
+			});
+			if (spaceship.closest.time > universal_time) {
+				next_event = std::min(next_event, spaceship.closest.time);
+			}
+			rails_arrived = plan_rails_step(dt, next_event);
+		}
+	}
+
+	if (playing) { //orbital simulation
+		//a rails step can span many orbits, which the field would need that many times the steps to follow:
+		set_pellets_on_conics(on_rails);
+
+		star->update(dt);
+		pellet_field.update(dt, universal_time); //before the rocket moves universal_time on to the end of the tick
+		asteroid.update(dt, spaceship.lasers);
+		spaceship.update(dt, asteroid);
+		engine_loop->set_volume(static_cast< float >(spaceship.thrust_percent) / 100.0f);
+		update_thrust_particles(dt);
+		pellet_orbits.update(dt);
+
+		for (size_t i = 0; i < pellets.size(); ++i) {
+			Particle &pellet = pellets[i].particle;
+			pellet.update(dt, pellet_orbits, pellet_field);
+			pellet_hash.update(hash_id(pellets.handle_at(i)), pellet.pos, pellet.radius);
+		}
+		//only the targeted pellet's conic is drawn, so only it needs following off the field's trajectory:
+		if (Pellet *targeted = pellets.get(target_pellet)) targeted->particle.refit_orbit();
+
+		//pellets are only tested against what the hash says is near, rather than every beam and the rocket:
+		bool any_consumed = false;
+		auto consume = [&](Particle &pellet) {
+			spaceship.fuel += pellet.value;
+			spaceship.fuel = std::min(std::max(spaceship.fuel, 0.0), spaceship.maxFuel);
+			pellet.bIsConsumed = true;
+			any_consumed = true;
+		};
+		std::vector< SpatialHash::Id > nearby;
+
+		if (laser_power > laser_closeness_for_particles && pellets.contains(target_pellet)) { // distance threshold
+			for (auto const &laser : spaceship.lasers) {
+				nearby.clear();
+				pellet_hash.query_segment(laser.pos - laser.compute_delta_pos(), laser.pos, laser.reach(), nearby);
+				for (SpatialHash::Id id : nearby) {
+					if (pellet_handle(id) != target_pellet) continue; // only for aimed particle
+					Particle &pellet = pellets.get(target_pellet)->particle;
+					if (pellet.id != -1 || pellet.bIsConsumed || !laser.collide(pellet.pos)) continue;
+					consume(pellet);
+				}
+			}
+		}
+
+		nearby.clear();
+		pellet_hash.query_sphere(spaceship.pos, 0.0, nearby);
+		for (SpatialHash::Id id : nearby) { // debris hit by the rocket
+			Pellet *hit = pellets.get(pellet_handle(id));
+			if (hit == nullptr) continue; //gone
+			Particle &pellet = hit->particle;
+			if (pellet.id != -2 || pellet.bIsConsumed) continue;
+			if (glm::distance2(spaceship.pos, pellet.pos) > pellet.radius * pellet.radius) continue;
+			consume(pellet);
+		}
+
+		if (any_consumed) {
+			//from the back, so the pellets moved into holes have already been looked at:
+			for (size_t i = pellets.size(); i-- > 0; ) {
+				if (pellets[i].particle.bIsConsumed) remove_pellet(pellets.handle_at(i));
+			}
+		}
+	}
+
+	if (rails_arrived) { //hand control back at the event
+		on_rails = false;
+		dilation = LEVEL_0;
+	}
+
+	if (playing) { // collision logic
+		if (asteroid.crashed) {
+			lock_target(&asteroid);
+			tab.downs = 1; // to trigger the camera transition
+			game_status = GameStatus::LOSE;
+			dilation = LEVEL_0;
+			on_rails = false;
+		}
+		else if (spaceship.crashed) {
+			lock_target(&spaceship);
+			tab.downs = 1; // to trigger the camera transition
+			game_status = GameStatus::LOSE;
+			dilation = LEVEL_0;
+			on_rails = false;
+		} else if (asteroid.time_of_collision == std::numeric_limits< float >::infinity()) {
+			lock_target(&spaceship);
+			tab.downs = 1; // to trigger the camera transition
+			game_status = GameStatus::WIN;
+			dilation = LEVEL_0;
+			on_rails = false;
+		}
+	}
+
+	if (playing && !bIsTutorial) { //laser
+		spaceship.update_lasers(dt);
+	}
+}
+
+void PlayMode::interpolate_transforms(double alpha) {
+	for (auto &[entity, transform] : entity_transforms) {
+		transform->position = glm::mix(entity->prev_pos, entity->pos, alpha);
+	}
+
+	auto turn = [&](Body const &body) {
+		auto found = entity_transforms.find(&body);
+		if (found != entity_transforms.end()) found->second->rotation = glm::quat(glm::dvec3(0., 0., body.spin));
+	};
+	for (Body const &body : bodies) turn(body);
+	for (Pellet &pellet : pellets) {
+		Particle const &particle = pellet.particle;
+		pellet.transform->position = glm::mix(particle.prev_pos, particle.pos, alpha);
+		pellet.transform->rotation = glm::quat(glm::dvec3(0., 0., particle.spin));
+	}
+
+	auto found = entity_transforms.find(&spaceship);
+	if (found != entity_transforms.end()) found->second->rotation = glm::quat(glm::dvec3(0., 0., spaceship.theta));
+}
+
+void PlayMode::attach_transform(Entity const &entity, Scene::Transform *transform) {
+	assert(transform != nullptr);
+	transform->position = entity.pos;
+	entity_transforms[&entity] = transform;
+}
+
+void PlayMode::attach_transform(Pellet &pellet, Scene::Transform *transform) {
+	assert(transform != nullptr);
+	transform->position = pellet.particle.pos;
+	pellet.transform = transform;
+}
+
+Entity const *PlayMode::target_lock() const {
+	if (Pellet const *pellet = pellets.get(target_pellet)) return &pellet->particle;
+	return target_entity;
+}
+
+void PlayMode::retarget(Entity const *from, Entity const *to) {
+	if (target_entity == from) target_entity = to;
+	if (current_focus_entity == from) current_focus_entity = (to != nullptr ? to : &spaceship);
+
+	auto found = camera_arms.find(from);
+	if (found == camera_arms.end()) return;
+	if (to != nullptr) {
+		CameraArm arm = found->second;
+		arm.entity = to;
+		camera_arms.erase(found);
+		camera_arms.insert({to, arm});
+	} else {
+		camera_arms.erase(found);
+	}
+}
+
+void PlayMode::remove_pellet(PelletHandle handle) {
+	Pellet *pellet = pellets.get(handle);
+	assert(pellet != nullptr);
+	detach_pellet(handle);
+	retarget(&pellet->particle, nullptr); //(a target lock on it goes stale by itself)
+
+	//the last pellet moves into this one's place, so whatever follows it by address has to follow it there:
+	Particle *hole = &pellet->particle;
+	Particle const *moved = &pellets.back().particle;
+	pellets.erase(handle);
+	if (moved != hole) retarget(moved, hole);
+}
+
+void PlayMode::attach_pellet(Particle &pellet) {
+	if (bNBodyPellets && !pellets_on_conics) {
+		pellet.attach(pellet_field);
+	} else {
+		pellet.attach(pellet_orbits);
+	}
+}
+
+void PlayMode::set_pellets_on_conics(bool on_conics) {
+	if (!bNBodyPellets || on_conics == pellets_on_conics) return;
+	pellets_on_conics = on_conics;
+
+	for (Pellet &pellet : pellets) {
+		Particle &particle = pellet.particle;
+		if (on_conics) {
+			if (particle.nbody_handle == NBodyBatch::InvalidHandle) continue;
+			particle.refit_orbit();
+			pellet_field.remove(particle.nbody_handle);
+			particle.nbody_handle = NBodyBatch::InvalidHandle;
+			particle.attach(pellet_orbits);
+		} else {
+			if (particle.batch_handle != OrbitBatch::InvalidHandle) {
+				pellet_orbits.remove(particle.batch_handle);
+				particle.batch_handle = OrbitBatch::InvalidHandle;
+			}
+			particle.attach(pellet_field); //(orbit is current, conics keep it so)
+		}
+	}
+}
+
+void PlayMode::detach_pellet(PelletHandle handle) {
+	Particle &pellet = pellets.get(handle)->particle;
+	if (pellet.batch_handle != OrbitBatch::InvalidHandle) pellet_orbits.remove(pellet.batch_handle);
+	if (pellet.nbody_handle != NBodyBatch::InvalidHandle) pellet_field.remove(pellet.nbody_handle);
+	pellet_hash.remove(hash_id(handle));
+}
+
+void PlayMode::init_thrust_particles() {
+	if (!thrust_particles) {
+		thrust_particles = std::make_unique< ThrustParticles >(*particle_meshes, particle_meshes->lookup("Particle"),
+			ThrustParticleCount, 0.04f);
+	}
+	thrust_particles->clear();
+	timeSinceLastParticle = 0.0;
+}
+
+void PlayMode::update_thrust_particles(double elapsed) {
+	if (spaceship.thrust_percent > 0){
+		glm::mat4x3 rocket_to_world = entity_transforms.at(&spaceship)->make_local_to_world();
+		double rate = glm::mix(0.0, 250.0, std::min((spaceship.thrust_percent / 10.0), 1.0));
+		while (timeSinceLastParticle > (1.0 / rate)) {
+			glm::vec3 position = rocket_to_world * glm::vec4(
+				-3.5, Utils::RandBetween(-0.5, 0.5), Utils::RandBetween(-0.5, 0.5), 1
+			);
+			glm::vec3 velocity = rocket_to_world * glm::vec4(
+				Utils::RandBetween(-10.5f, -5.0f), 0, 0, 0.0
+			);
+			thrust_particles->spawn(position, velocity, Utils::RandBetween(0.34f, 0.36f));
+			timeSinceLastParticle -= (1.0 / rate);
+		}
+		timeSinceLastParticle += elapsed;
+	}
+
+	thrust_particles->advance(elapsed);
+}
+
 void PlayMode::RenderFrameQuad(){
 	if (renderQuadVAO == 0)
     {
@@ -1304,13 +1556,21 @@ void PlayMode::draw(glm::uvec2 const &drawable_size) {
 	//update camera aspect ratio for drawable:
 	camera->aspect = float(drawable_size.x) / float(drawable_size.y);
 
-	//set up light type and position for lit_color_texture_program:
-	glUseProgram(lit_color_texture_program->program);
-	glUniform3fv(lit_color_texture_program->AMBIENT_COLOR_vec3, 1, glm::value_ptr(glm::vec3(ambient_light)));
-	glUniform3fv(lit_color_texture_program->LIGHT_DIRECTION_vec3, 1, glm::value_ptr(glm::vec3(0.0f, 0.0f,-1.0f)));
-	glUniform3fv(lit_color_texture_program->LIGHT_LOCATION_vec3, 1, glm::value_ptr(star->transform->position));
-	glUniform3fv(lit_color_texture_program->LIGHT_ENERGY_vec3, 1, glm::value_ptr(glm::vec3(1.0f, 1.0f, 0.95f)));
-	glUseProgram(0);
+	//camera and light, shared by every program through the Frame uniform block:
+	glm::mat4 world_to_clip;
+	{
+		FrameUniforms frame;
+		frame.WORLD_TO_VIEW = glm::mat4(camera->transform->make_world_to_local());
+		frame.PROJECTION = camera->make_projection();
+		frame.WORLD_TO_CLIP = frame.PROJECTION * frame.WORLD_TO_VIEW;
+		frame.LIGHT_LOCATION = glm::vec4(entity_transforms.at(star)->position, 1.0f);
+		frame.LIGHT_DIRECTION = glm::vec4(0.0f, 0.0f,-1.0f, 0.0f);
+		frame.LIGHT_ENERGY = glm::vec4(1.0f, 1.0f, 0.95f, 0.0f);
+		frame.AMBIENT_COLOR = glm::vec4(glm::vec3(ambient_light), 0.0f);
+		set_frame_uniforms(frame);
+		world_to_clip = frame.WORLD_TO_CLIP;
+	}
+	Frustum frustum(world_to_clip); //to skip whatever is out of view
 
 	glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -1323,12 +1583,34 @@ void PlayMode::draw(glm::uvec2 const &drawable_size) {
 
 	scene.draw(*camera);
 
+	{ //pellets, one instanced draw per mesh, then the exhaust in another
+		for (auto &[name, batch] : pellet_instances) {
+			batch.instances.clear();
+		}
+		for (Pellet const &pellet : pellets) {
+			Scene::Transform const &transform = *pellet.transform;
+			auto batch = pellet_instances.find(transform.name);
+			if (batch == pellet_instances.end()) {
+				batch = pellet_instances.try_emplace(transform.name, *main_meshes->meshes,
+					main_meshes->meshes->lookup(transform.name)).first;
+			}
+			batch->second.instances.emplace_back(transform.position, transform.scale.x,
+				static_cast< float >(pellet.particle.spin));
+		}
+		for (auto &[name, batch] : pellet_instances) {
+			batch.cull(frustum);
+			batch.draw();
+		}
+
+		if (thrust_particles) thrust_particles->draw(frustum);
+	}
+
     for(auto it = fancyPlanets.begin(); it != fancyPlanets.end(); it++){
-        it->draw(camera);
+        it->draw(frustum);
     }
 
     // skybox comes last always
-    skybox.draw(camera);
+    skybox.draw();
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	if (hdrFBO == 0)
@@ -1367,37 +1649,30 @@ void PlayMode::draw(glm::uvec2 const &drawable_size) {
 	glDisable(GL_DEPTH_TEST);
 
 	{
-		glm::mat4 world_to_clip = camera->make_projection() * glm::mat4(camera->transform->make_world_to_local());
-		DrawLines orbit_lines(world_to_clip);
 
 		static constexpr glm::u8vec4 grey = glm::u8vec4(0x80, 0x80, 0x80, 0xff);
 		static constexpr glm::u8vec4 cyan = glm::u8vec4(0x00, 0xff, 0xff, 0xff);
 		static constexpr glm::u8vec4 green = glm::u8vec4(0x00, 0xff, 0x00, 0xff);
 
-		star->draw_orbits(orbit_lines, grey, CurrentCameraArm().get_camera_arm_dist());
-		spaceship.orbits.front().draw(orbit_lines, cyan);
-		asteroid.orbits.front().draw(orbit_lines, green);
+		{ // closed orbits of bodies (and pellets), drawn from their elements in one call
+			OrbitConics orbit_conics(world_to_clip);
+			star->draw_orbits(orbit_conics, grey);
 
-		{ // draw the orbit of the fuel being hovered over
+			// draw the orbit of the fuel being hovered over
 			static constexpr glm::u8vec4 red = glm::u8vec4(0xff, 0x00, 0x00, 0xff);
-			if (target_lock != nullptr) {
-				for (Particle const &p : fuel_pellets) {
-					if (&p == target_lock) {
-						p.orbit->draw(orbit_lines, red);
-					}
-				}
-				for (Particle const &p : debris_pellets) {
-					if (&p == target_lock) {
-						p.orbit->draw(orbit_lines, red);
-					}
-				}
+			if (Pellet const *targeted = pellets.get(target_pellet)) {
+				orbit_conics.draw(*targeted->particle.orbit, red);
 			}
 		}
+
+		// predicted paths, which change course at SOI transitions
+		OrbitLines orbit_lines(world_to_clip);
+		spaceship.orbits.front().draw(orbit_lines, cyan);
+		asteroid.orbits.front().draw(orbit_lines, green);
 	}
 
 
 	if (true) { //DEBUG: draw spaceship (relative) position, (relative) velocity, heading, and acceleration vectors
-		glm::mat4 world_to_clip = camera->make_projection() * glm::mat4(camera->transform->make_world_to_local());
 		DrawLines vector_lines(world_to_clip);
 
 		// Orbit const &orbit = spaceship.orbits.front();
@@ -1442,12 +1717,12 @@ void PlayMode::draw(glm::uvec2 const &drawable_size) {
 			};
 			draw_circle(spaceship.pos, glm::vec2(circle_radius), white);
 
-			for (Particle const &pellet : fuel_pellets) {
-				draw_circle(pellet.pos, circle_radius * glm::vec2(0.1f, 0.1f), fuel, 6);
-			}
-
-			for (Particle const &pellet : debris_pellets) {
-				draw_circle(pellet.pos, circle_radius * glm::vec2(0.1f, 0.1f), debris, 10);
+			for (Pellet const &pellet : pellets) {
+				if (pellet.particle.id == -1) {
+					draw_circle(pellet.particle.pos, circle_radius * glm::vec2(0.1f, 0.1f), fuel, 6);
+				} else {
+					draw_circle(pellet.particle.pos, circle_radius * glm::vec2(0.1f, 0.1f), debris, 10);
+				}
 			}
 		}
 
@@ -1467,11 +1742,10 @@ void PlayMode::draw(glm::uvec2 const &drawable_size) {
 	}
 
 	{ // draw spaceship laser beams (screenspace)
-		glm::mat4 world_to_clip = camera->make_projection() * glm::mat4(camera->transform->make_world_to_local());
-		DrawLines line_drawer(world_to_clip);
+		DrawBeams beam_drawer(world_to_clip);
 
 		for (const Beam &L : spaceship.lasers){
-			L.draw(line_drawer);
+			L.draw(beam_drawer);
 		}
 	}
 
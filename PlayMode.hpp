@@ -2,10 +2,14 @@
 #include "Mode.hpp"
 
 #include "OrbitalMechanics.hpp"
+#include "SlotMap.hpp"
+#include "SpatialHash.hpp"
 #include "Skybox.hpp"
 #include "FancyPlanet.hpp"
 
 #include "Mesh.hpp"
+#include "MeshInstances.hpp"
+#include "ThrustParticles.hpp"
 #include "Scene.hpp"
 #include "Sound.hpp"
 #include "Text.hpp"
@@ -14,6 +18,7 @@
 #include <glm/glm.hpp>
 
 #include <list>
+#include <memory>
 #include <fstream>
 #include <vector>
 #include <unordered_map>
@@ -33,7 +38,7 @@ struct PlayMode : Mode {
 
 	void serialize(std::string const &filename);
 	void serialize_orbit(std::ofstream &file, Orbit const &orbit);
-	void serialize_body(std::ofstream &file, Body const &body);
+	void serialize_body(std::ofstream &file, Body const &body, std::string const &transform_name);
 	void serialize_rocket(std::ofstream &file);
 	void serialize_asteroid(std::ofstream &file);
 
@@ -89,7 +94,6 @@ struct PlayMode : Mode {
 	HUD::Sprite *reticle;
 	HUD::Sprite *buttons;
 	HUD::Sprite *lasercooldown;
-	const Entity *target_lock = nullptr;
 
 	glm::vec2 target_xy;
 
@@ -126,10 +130,40 @@ struct PlayMode : Mode {
 
 	// spaceship
 	Rocket spaceship;
+	std::shared_ptr< Sound::PlayingSample > engine_loop;
+
+	// spaceship exhaust, purely visual (kept out of the simulation, which runs headless)
+	static int constexpr ThrustParticleCount = 100;
+	std::unique_ptr< ThrustParticles > thrust_particles; //animated and drawn on the GPU
+	double timeSinceLastParticle = 0.0;
+	void init_thrust_particles();
+	void update_thrust_particles(double elapsed);
 
 	// spaceship fuel
-	std::list< Particle > fuel_pellets;
-	std::list< Particle > debris_pellets;
+	struct Pellet {
+		Pellet(int id, double radius) : particle(id, radius) {}
+		Particle particle; //fuel (id -1) or debris (id -2)
+		Scene::Transform *transform = nullptr; //where it is drawn
+	};
+	typedef SlotMap< Pellet >::Handle PelletHandle;
+	SlotMap< Pellet > pellets; //moves pellets on removal, see remove_pellet
+	std::unordered_map< std::string, MeshInstances > pellet_instances; //drawn per mesh (= transform name), not as drawables
+	void remove_pellet(PelletHandle handle);
+	OrbitBatch pellet_orbits; //propagates both fuel and debris pellets
+	NBodyBatch pellet_field; //integrates them under every body's gravity instead, in N-body mode
+	bool bNBodyPellets = false; //N-body mode (params.ini), applies to pellets loaded afterwards
+	bool pellets_on_conics = false; //N-body pellets handed back to their conics for the rails warp
+	void set_pellets_on_conics(bool on_conics);
+	SpatialHash pellet_hash = SpatialHash(10.0); //broadphase for beam and rocket hits, cells 10 Megameters across
+	void attach_pellet(Particle &pellet);
+	void detach_pellet(PelletHandle handle);
+
+	//what the reticle is locked onto, a pellet (by handle, so one since consumed reads as gone) or else an entity:
+	PelletHandle target_pellet;
+	Entity const *target_entity = nullptr;
+	Entity const *target_lock() const; //null if nothing (left) to lock onto
+	void lock_target(Entity const *entity) { target_pellet = PelletHandle(); target_entity = entity; }
+	void lock_target(PelletHandle handle) { target_pellet = handle; target_entity = nullptr; }
 	size_t fuel_particle_count = 30;
 	size_t debris_particle_count = 10;
 	int laser_closeness_for_particles = 40; // percent threshold that the laser needs to have to have effect on particles
@@ -138,14 +172,30 @@ struct PlayMode : Mode {
 	bool bCanThrustChangeDir = true; // whether or not we can thrust
 	bool forward_thrust = true; // false => backwards thrust controls
 
-	static double constexpr MaxSimElapsed = 1.0 / 120.0;
+	//fixed-step simulation (tick rate and catch-up budget come from params.ini):
+	double sim_tick = 1.0 / 120.0; //seconds simulated per tick
+	uint32_t max_catch_up_ticks = 8; //most ticks run in one frame, any more real time than that is dropped
+	double sim_accumulator = 0.0; //real time not yet simulated
+	void tick(double dt, int laser_power);
+	//place entity transforms alpha of the way from their previous to current simulated position (and turn them):
+	void interpolate_transforms(double alpha);
 
 	// asteroid
 	Asteroid asteroid = Asteroid(0.5f, 0.2f);
 
 	// other solar system bodies
 	Body *star = nullptr; //All body updates cascade off of star update, should be done prior to spaceship update
-	std::list< Entity* > entities; // bodies + rocket(s)
+	std::vector< Entity * > entities; // bodies + rocket(s), everything with a fixed address (so not pellets)
+	std::unordered_map< Entity const *, Scene::Transform * > entity_transforms; //where each of those is drawn
+	void attach_transform(Entity const &entity, Scene::Transform *transform);
+	void attach_transform(Pellet &pellet, Scene::Transform *transform);
+	template< typename F >
+	void for_each_entity(F const &f) { //entities, then pellets
+		for (Entity *entity : entities) f(*entity);
+		for (Pellet &pellet : pellets) f(pellet.particle);
+	}
+	//point whatever referred to entity from at to instead (or at nothing, if to is null):
+	void retarget(Entity const *from, Entity const *to);
 	std::list< Body > bodies;
 	std::list< Orbit > orbits;
 	std::unordered_map< int, Body * > id_to_body;
@@ -208,9 +258,10 @@ struct PlayMode : Mode {
 	struct CameraArm { //Encapsulated so that we can have individually tracked views per body later on
 
 		CameraArm() = delete; // must pass in an Entity to focus on!
-		CameraArm(const Entity *e) : entity(e) {}
+		CameraArm(const Entity *e, const Scene::Transform *t) : entity(e), transform(t) {}
 
 		const Entity *entity = nullptr;
+		const Scene::Transform *transform = nullptr; //where entity is drawn (interpolated between steps), if anywhere
 
 		static float constexpr ScrollSensitivity = 3.5f;
 
@@ -220,6 +271,8 @@ struct PlayMode : Mode {
 
 		inline static glm::vec3 camera_pan_offset{1.0f, 1.0f, 1.0f}; // must not be zeros
 		inline const glm::vec3 get_focus_point() const { // for smooth transitions
+			//follow the drawn (interpolated) position so the focus doesn't jitter against the camera
+			if (transform != nullptr) return transform->position;
 			return entity->pos;
 		};
 
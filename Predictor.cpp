@@ -0,0 +1,115 @@
+#include "Predictor.hpp"
+
+#include <cassert>
+#include <iterator>
+
+Predictor::Predictor() {
+	thread = std::thread(&Predictor::run, this);
+}
+
+Predictor::~Predictor() {
+	{
+		std::unique_lock< std::mutex > lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	thread.join();
+}
+
+void Predictor::copy_chain(std::list< Orbit > const &from, std::list< Orbit > &to) {
+	to = from;
+	//continuations follow list order (see Orbit::sim_predict), so relink each one to the next copy:
+	for (auto it = to.begin(); it != to.end(); ++it) {
+		if (it->continuation == nullptr) continue;
+		auto next = std::next(it);
+		it->continuation = next != to.end() ? &(*next) : nullptr;
+	}
+}
+
+uint64_t Predictor::request(Orbit const &orbit, double start_time, std::list< Orbit > const *target) {
+	std::unique_lock< std::mutex > lock(mutex);
+	pending.generation = ++generation;
+	pending.orbits.clear();
+	pending.orbits.emplace_back(orbit);
+	pending.orbits.front().continuation = nullptr;
+	if (target != nullptr) {
+		copy_chain(*target, pending.target);
+	} else {
+		pending.target.clear();
+	}
+	pending.start_time = start_time;
+	has_pending = true;
+	lock.unlock();
+
+	wake.notify_one();
+	return generation;
+}
+
+bool Predictor::poll() {
+	std::unique_lock< std::mutex > lock(mutex);
+	if (ready.generation <= current.generation) return false;
+	std::swap(ready, current);
+	return true;
+}
+
+bool Predictor::settled() {
+	std::unique_lock< std::mutex > lock(mutex);
+	return !has_pending && !busy && ready.generation <= current.generation;
+}
+
+void Predictor::cancel() {
+	std::unique_lock< std::mutex > lock(mutex);
+	has_pending = false;
+	cancelled = generation;
+	ready = Result();
+	current = Result();
+	idle.wait(lock, [this]() { return !busy; });
+}
+
+void Predictor::run() {
+	Request request;
+	Result working;
+
+	std::unique_lock< std::mutex > lock(mutex);
+	while (true) {
+		wake.wait(lock, [this]() { return quit || has_pending; });
+		if (quit) return;
+		std::swap(request, pending);
+		has_pending = false;
+		busy = true;
+		lock.unlock();
+
+		working.generation = request.generation;
+		working.orbits.clear();
+		working.orbits.splice(working.orbits.end(), request.orbits);
+		Orbit &orbit = working.orbits.front();
+		orbit.sim_predict(working.orbits, 0, working.orbits.begin(), request.start_time);
+		working.closest = ClosestApproachInfo();
+		if (!request.target.empty()) {
+			orbit.find_closest_approach(request.target.front(), working.closest);
+		}
+		working.time_of_collision = orbit.find_time_of_collision();
+
+		lock.lock();
+		busy = false;
+		if (working.generation > cancelled) {
+			//NOTE: swapping lists keeps their nodes in place, so continuation pointers stay valid
+			std::swap(working, ready);
+		}
+		idle.notify_all();
+	}
+}
+
+bool Predictor::Result::adopt(std::list< Orbit > &live) {
+	assert(!live.empty() && !orbits.empty());
+	Orbit &front = live.front();
+	Orbit &predicted = orbits.front();
+	if (front.origin != predicted.origin) return false;
+
+	//move the predicted continuations over, replacing the old ones:
+	//NOTE: splicing keeps the nodes in place, so predicted.continuation stays valid
+	live.erase(std::next(live.begin()), live.end());
+	live.splice(live.end(), orbits, std::next(orbits.begin()), orbits.end());
+	front.take_prediction(predicted);
+	return true;
+}
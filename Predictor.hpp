@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ * Background worker for trajectory prediction (Orbit::sim_predict and the searches run on its result).
+ *
+ * The main thread hands over a copy of the orbit to predict and gets back a finished Orbit chain later. Requests are
+ * tagged with an increasing generation; a newer request supersedes any that has not started yet, and poll() only
+ * ever picks up results newer than the current one. Results are double-buffered: the worker fills its
+ * own chain and swaps it into the ready slot, so the main thread never waits on a prediction in progress.
+ *
+ * Bodies are only read through Body::state_at (fixed orbit elements, ephemeris) while a prediction runs, so the
+ * main thread is free to keep updating them.
+ *
+ */
+
+#include "OrbitalMechanics.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <thread>
+
+struct Predictor {
+	Predictor();
+	~Predictor();
+	Predictor(Predictor const &) = delete;
+	Predictor &operator=(Predictor const &) = delete;
+
+	struct Result {
+		uint64_t generation = 0; //0 => no result
+		std::list< Orbit > orbits; //predicted chain; orbits.front() is the orbit the request was made with
+		ClosestApproachInfo closest; //closest approach to the request's target, if it had one
+		double time_of_collision = std::numeric_limits< double >::infinity();
+
+		//hand the prediction over to live: front of live keeps its dynamics, everything else comes from here
+		//returns false (leaving live alone) if live has since changed origin, so the prediction no longer applies
+		bool adopt(std::list< Orbit > &live);
+	};
+
+	//predict orbit from start_time (universal time), also finding the closest approach to target's chain if given:
+	uint64_t request(Orbit const &orbit, double start_time, std::list< Orbit > const *target = nullptr);
+	//if a result newer than current is ready, make it current and return true:
+	bool poll();
+	Result current; //latest result taken by poll(), only touched by the main thread
+	//true if nothing is queued, in flight, or waiting for poll(), so current describes the latest request
+	bool settled();
+	//drop all queued and finished work and wait for the prediction in flight, if any
+	//NOTE: call before the bodies predictions refer to are destroyed
+	void cancel();
+
+	//copy a chain of orbits, pointing continuations at the copies:
+	static void copy_chain(std::list< Orbit > const &from, std::list< Orbit > &to);
+
+	//-- internals --
+	struct Request {
+		uint64_t generation = 0;
+		std::list< Orbit > orbits; //just the orbit to predict
+		std::list< Orbit > target;
+		double start_time = 0.0;
+	};
+
+	void run();
+
+	std::mutex mutex;
+	std::condition_variable wake; //signalled on new request or quit
+	std::condition_variable idle; //signalled when a prediction finishes
+
+	//guarded by mutex:
+	Request pending;
+	bool has_pending = false;
+	bool busy = false;
+	bool quit = false;
+	uint64_t generation = 0; //of the most recent request
+	uint64_t cancelled = 0; //results at or below this generation are dropped
+	Result ready;
+
+	std::thread thread; //started last, once everything above is initialized
+};
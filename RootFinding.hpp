@@ -0,0 +1,97 @@
+#pragma once
+
+/*
+ * Scalar root finding and minimization, used for locating events (SOI transitions, encounters, closest approaches)
+ * along predicted orbits.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//Brent's method: root of f in [a, b], where fa = f(a) and fb = f(b) have opposite signs (or one is zero)
+//Combines bisection with secant/inverse quadratic steps, so it never does worse than bisection but usually converges
+// superlinearly: https://en.wikipedia.org/wiki/Brent%27s_method
+template< typename F >
+double brent_root(F const &f, double a, double b, double fa, double fb, double tolerance, int max_iterations = 64) {
+	if (fa == 0.0) return a;
+	if (fb == 0.0) return b;
+
+	double c = b, fc = fb;
+	double d = b - a, e = d;
+	for (int i = 0; i < max_iterations; i++) {
+		if ((fb > 0.0) == (fc > 0.0)) { //keep the root bracketed between b and c
+			c = a;
+			fc = fa;
+			d = e = b - a;
+		}
+		if (std::abs(fc) < std::abs(fb)) { //b is the best estimate so far
+			a = b; b = c; c = a;
+			fa = fb; fb = fc; fc = fa;
+		}
+
+		double tol = 2.0 * std::numeric_limits< double >::epsilon() * std::abs(b) + 0.5 * tolerance;
+		double half = 0.5 * (c - b);
+		if (std::abs(half) <= tol || fb == 0.0) return b;
+
+		if (std::abs(e) >= tol && std::abs(fa) > std::abs(fb)) { //try interpolation
+			double s = fb / fa;
+			double p, q;
+			if (a == c) { //secant
+				p = 2.0 * half * s;
+				q = 1.0 - s;
+			} else { //inverse quadratic
+				double qa = fa / fc;
+				double r = fb / fc;
+				p = s * (2.0 * half * qa * (qa - r) - (b - a) * (r - 1.0));
+				q = (qa - 1.0) * (r - 1.0) * (s - 1.0);
+			}
+			if (p > 0.0) q = -q;
+			p = std::abs(p);
+			if (2.0 * p < std::min(3.0 * half * q - std::abs(tol * q), std::abs(e * q))) { //accept interpolation
+				e = d;
+				d = p / q;
+			} else { //fall back to bisection
+				d = half;
+				e = d;
+			}
+		} else { //bisection
+			d = half;
+			e = d;
+		}
+
+		a = b;
+		fa = fb;
+		b += std::abs(d) > tol ? d : (half > 0.0 ? tol : -tol);
+		fb = f(b);
+	}
+	return b;
+}
+
+//Golden-section search: minimum of f in [a, b], assuming f is unimodal there
+//Shrinks the bracket by a constant ratio per evaluation: https://en.wikipedia.org/wiki/Golden-section_search
+template< typename F >
+double golden_section_min(F const &f, double a, double b, double tolerance, int max_iterations = 128) {
+	static double constexpr InvPhi = 0.61803398874989484820; //=1/golden ratio
+	double x1 = b - InvPhi * (b - a);
+	double x2 = a + InvPhi * (b - a);
+	double f1 = f(x1);
+	double f2 = f(x2);
+	for (int i = 0; i < max_iterations && std::abs(b - a) > tolerance; i++) {
+		if (f1 < f2) {
+			b = x2;
+			x2 = x1;
+			f2 = f1;
+			x1 = b - InvPhi * (b - a);
+			f1 = f(x1);
+		} else {
+			a = x1;
+			x1 = x2;
+			f1 = f2;
+			x2 = a + InvPhi * (b - a);
+			f2 = f(x2);
+		}
+	}
+	return 0.5 * (a + b);
+}
@@ -1,11 +1,16 @@
 #include "Scene.hpp"
+#include "Frustum.hpp"
+#include "UniformBlocks.hpp"
 
 #include "gl_errors.hpp"
 #include "read_write_chunk.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <limits>
 
 //-------------------------
 //Helper to set up a drawable given a transform. Note that mesh_name comes from transform->name.
@@ -23,6 +28,8 @@ Scene::Drawable *Scene::make_drawable(Scene &scene, Scene::Transform *transform,
 	drawable.pipeline.start = mesh.start;
 	drawable.pipeline.count = mesh.count;
 
+	drawable.bounds = mesh_bounding_sphere(mesh);
+
 	return &drawable;
 }
 
@@ -73,18 +80,65 @@ glm::mat4x3 Scene::Transform::make_parent_to_local() const {
 	);
 }
 
-glm::mat4x3 Scene::Transform::make_local_to_world() const {
+//every rebuild of any transform's world cache gets a fresh revision, so a child notices its parent changed
+// (even if the parent was destroyed and another transform has since been made at the same address):
+static uint64_t next_world_revision = 1;
+
+void Scene::Transform::update_world_cache(uint64_t pass) const {
+	WorldCache &cache = world_cache;
+	if (pass != 0) {
+		if (cache.pass == pass) return;
+		cache.pass = pass;
+	}
+
+	//the fields are public, so "dirty" means "different from what the cache was built from":
+	uint64_t parent_revision = 0;
+	if (parent) {
+		parent->update_world_cache(pass);
+		parent_revision = parent->world_cache.revision;
+	}
+	if (cache.revision != 0
+	 && cache.parent == parent && cache.parent_revision == parent_revision
+	 && cache.position == position && cache.rotation == rotation && cache.scale == scale) return;
+
+	cache.parent = parent;
+	cache.parent_revision = parent_revision;
+	cache.position = position;
+	cache.rotation = rotation;
+	cache.scale = scale;
 	if (!parent) {
-		return make_local_to_parent();
+		cache.local_to_world = make_local_to_parent();
 	} else {
-		return parent->make_local_to_world() * glm::mat4(make_local_to_parent()); //note: glm::mat4(glm::mat4x3) pads with a (0,0,0,1) row
+		cache.local_to_world = parent->world_cache.local_to_world * glm::mat4(make_local_to_parent()); //note: glm::mat4(glm::mat4x3) pads with a (0,0,0,1) row
 	}
+	cache.has_world_to_local = false;
+	cache.revision = next_world_revision++;
+}
+
+glm::mat4x3 Scene::Transform::make_local_to_world() const {
+	update_world_cache();
+	return world_cache.local_to_world;
 }
 glm::mat4x3 Scene::Transform::make_world_to_local() const {
-	if (!parent) {
-		return make_parent_to_local();
-	} else {
-		return make_parent_to_local() * glm::mat4(parent->make_world_to_local()); //note: glm::mat4(glm::mat4x3) pads with a (0,0,0,1) row
+	update_world_cache();
+	if (!world_cache.has_world_to_local) {
+		if (!parent) {
+			world_cache.world_to_local = make_parent_to_local();
+		} else {
+			world_cache.world_to_local = make_parent_to_local() * glm::mat4(parent->make_world_to_local()); //note: glm::mat4(glm::mat4x3) pads with a (0,0,0,1) row
+		}
+		world_cache.has_world_to_local = true;
+	}
+	return world_cache.world_to_local;
+}
+
+void Scene::update_transforms() const {
+	//each transform checks its parents before itself, and the pass number stops anything being checked twice,
+	// so this visits the hierarchy in topological order, doing each transform's matrix math at most once:
+	static uint64_t next_pass = 1;
+	uint64_t pass = next_pass++;
+	for (auto const &transform : transforms) {
+		transform.update_world_cache(pass);
 	}
 }
 
@@ -124,8 +178,14 @@ void Scene::draw(Camera const &camera) const {
 }
 
 void Scene::draw(glm::mat4 const &world_to_clip, glm::mat4x3 const &world_to_light) const {
-
-	//Iterate through all drawables, sending each one to OpenGL:
+	update_transforms();
+
+	//Gather everything drawable into the render queue, along with what it needs bound and how far away it is:
+	render_queue.clear();
+	cull_batch.x.clear();
+	cull_batch.y.clear();
+	cull_batch.z.clear();
+	cull_batch.radius.clear();
 	for (auto const &drawable : drawables) {
 		//Reference to drawable's pipeline for convenience:
 		Scene::Drawable::Pipeline const &pipeline = drawable.pipeline;
@@ -139,64 +199,141 @@ void Scene::draw(glm::mat4 const &world_to_clip, glm::mat4x3 const &world_to_lig
 		//skip any disabled objects
 		if (!drawable.transform->enabled) continue;
 
-
-		//Set shader program:
-		glUseProgram(pipeline.program);
-
-		//Set attribute sources:
-		glBindVertexArray(pipeline.vao);
-
-		//Configure program uniforms:
-
-		//the object-to-world matrix is used in all three of these uniforms:
+		//the object-to-world matrix is used in all three uniforms below, and for the depth sort:
 		assert(drawable.transform); //drawables *must* have a transform
 		glm::mat4x3 object_to_world = drawable.transform->make_local_to_world();
+		float depth = (world_to_clip * glm::vec4(object_to_world[3], 1.0f)).w;
+		render_queue.emplace_back(QueuedDrawable{ &drawable, object_to_world, depth });
+
+		//world-space bounding sphere (scaled by the longest axis, so it still encloses under non-uniform scale):
+		glm::vec3 center = object_to_world * glm::vec4(glm::vec3(drawable.bounds), 1.0f);
+		float radius = std::numeric_limits< float >::infinity(); //unknown bounds => always visible
+		if (drawable.bounds.w >= 0.0f) {
+			float scale2 = std::max(glm::dot(object_to_world[0], object_to_world[0]),
+				std::max(glm::dot(object_to_world[1], object_to_world[1]), glm::dot(object_to_world[2], object_to_world[2])));
+			radius = drawable.bounds.w * std::sqrt(scale2);
+		}
+		cull_batch.x.emplace_back(center.x);
+		cull_batch.y.emplace_back(center.y);
+		cull_batch.z.emplace_back(center.z);
+		cull_batch.radius.emplace_back(radius);
+	}
+
+	//Drop anything entirely outside the view, testing every bounding sphere at once:
+	cull_batch.visible.resize(render_queue.size());
+	Frustum(world_to_clip).spheres_visible(render_queue.size(), cull_batch.x.data(), cull_batch.y.data(),
+		cull_batch.z.data(), cull_batch.radius.data(), cull_batch.visible.data());
+	size_t kept = 0;
+	for (size_t i = 0; i < render_queue.size(); ++i) {
+		if (cull_batch.visible[i]) render_queue[kept++] = render_queue[i];
+	}
+	render_queue.resize(kept);
+
+	//Sort so drawables sharing state are adjacent (most expensive state change first), nearest first within that:
+	std::sort(render_queue.begin(), render_queue.end(), [](QueuedDrawable const &a, QueuedDrawable const &b) {
+		Scene::Drawable::Pipeline const &pa = a.drawable->pipeline;
+		Scene::Drawable::Pipeline const &pb = b.drawable->pipeline;
+		if (pa.program != pb.program) return pa.program < pb.program;
+		if (pa.vao != pb.vao) return pa.vao < pb.vao;
+		for (uint32_t i = 0; i < Drawable::Pipeline::TextureCount; ++i) {
+			if (pa.textures[i].texture != pb.textures[i].texture) return pa.textures[i].texture < pb.textures[i].texture;
+		}
+		return a.depth < b.depth;
+	});
+
+	//Compute every drawable's transforms, and upload them all at once for programs reading the Object block:
+	object_uniforms.resize(render_queue.size());
+	bool any_object_block = false;
+	for (size_t i = 0; i < render_queue.size(); ++i) {
+		Scene::Drawable::Pipeline const &pipeline = render_queue[i].drawable->pipeline;
+		glm::mat4 object_to_world = glm::mat4(render_queue[i].object_to_world); //note: glm::mat4(glm::mat4x3) pads with a (0,0,0,1) row
+		ObjectUniforms &object = object_uniforms[i];
 
 		//OBJECT_TO_CLIP takes vertices from object space to clip space:
-		if (pipeline.OBJECT_TO_CLIP_mat4 != -1U) {
-			glm::mat4 object_to_clip = world_to_clip * glm::mat4(object_to_world);
-			glUniformMatrix4fv(pipeline.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(object_to_clip));
+		object.OBJECT_TO_CLIP = world_to_clip * object_to_world;
+		//OBJECT_TO_LIGHT takes vertices from object space to light space:
+		object.OBJECT_TO_LIGHT = glm::mat4(world_to_light * object_to_world);
+		//NORMAL_TO_LIGHT takes normals from object space to light space:
+		if (pipeline.object_uniforms || pipeline.NORMAL_TO_LIGHT_mat3 != -1U) {
+			glm::mat3 normal_to_light = glm::inverse(glm::transpose(glm::mat3(object.OBJECT_TO_LIGHT)));
+			for (uint32_t c = 0; c < 3; ++c) object.NORMAL_TO_LIGHT[c] = glm::vec4(normal_to_light[c], 0.0f);
 		}
+		any_object_block = any_object_block || pipeline.object_uniforms;
+	}
+	if (any_object_block) set_object_uniforms(object_uniforms);
+
+	//State as last set, so that only changes are sent to OpenGL:
+	GLuint current_program = 0;
+	GLuint current_vao = 0;
+	GLuint current_unit = -1U; //whatever was left active before draw()
+	Drawable::Pipeline::TextureInfo current_textures[Drawable::Pipeline::TextureCount];
+	auto bind_texture = [&](uint32_t i, GLenum target, GLuint texture) {
+		if (current_unit != i) {
+			glActiveTexture(GL_TEXTURE0 + i);
+			current_unit = i;
+		}
+		glBindTexture(target, texture);
+	};
 
-		//the object-to-light matrix is used in the next two uniforms:
-		glm::mat4x3 object_to_light = world_to_light * glm::mat4(object_to_world);
+	//Send each drawable to OpenGL:
+	for (size_t q = 0; q < render_queue.size(); ++q) {
+		Scene::Drawable const &drawable = *render_queue[q].drawable;
+		Scene::Drawable::Pipeline const &pipeline = drawable.pipeline;
 
-		//OBJECT_TO_CLIP takes vertices from object space to light space:
-		if (pipeline.OBJECT_TO_LIGHT_mat4x3 != -1U) {
-			glUniformMatrix4x3fv(pipeline.OBJECT_TO_LIGHT_mat4x3, 1, GL_FALSE, glm::value_ptr(object_to_light));
+		//Set shader program:
+		if (pipeline.program != current_program) {
+			glUseProgram(pipeline.program);
+			current_program = pipeline.program;
 		}
 
-		//NORMAL_TO_CLIP takes normals from object space to light space:
-		if (pipeline.NORMAL_TO_LIGHT_mat3 != -1U) {
-			glm::mat3 normal_to_light = glm::inverse(glm::transpose(glm::mat3(object_to_light)));
-			glUniformMatrix3fv(pipeline.NORMAL_TO_LIGHT_mat3, 1, GL_FALSE, glm::value_ptr(normal_to_light));
+		//Set attribute sources:
+		if (pipeline.vao != current_vao) {
+			glBindVertexArray(pipeline.vao);
+			current_vao = pipeline.vao;
+		}
+
+		//Configure program uniforms:
+		ObjectUniforms const &object = object_uniforms[q];
+		if (pipeline.object_uniforms) {
+			bind_object_uniforms(q);
+		} else {
+			if (pipeline.OBJECT_TO_CLIP_mat4 != -1U) {
+				glUniformMatrix4fv(pipeline.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(object.OBJECT_TO_CLIP));
+			}
+			if (pipeline.OBJECT_TO_LIGHT_mat4x3 != -1U) {
+				glm::mat4x3 object_to_light = glm::mat4x3(object.OBJECT_TO_LIGHT);
+				glUniformMatrix4x3fv(pipeline.OBJECT_TO_LIGHT_mat4x3, 1, GL_FALSE, glm::value_ptr(object_to_light));
+			}
+			if (pipeline.NORMAL_TO_LIGHT_mat3 != -1U) {
+				glm::mat3 normal_to_light = glm::mat3(glm::vec3(object.NORMAL_TO_LIGHT[0]),
+					glm::vec3(object.NORMAL_TO_LIGHT[1]), glm::vec3(object.NORMAL_TO_LIGHT[2]));
+				glUniformMatrix3fv(pipeline.NORMAL_TO_LIGHT_mat3, 1, GL_FALSE, glm::value_ptr(normal_to_light));
+			}
 		}
 
 		//set any requested custom uniforms:
 		if (pipeline.set_uniforms) pipeline.set_uniforms();
 		if (drawable.set_uniforms) drawable.set_uniforms();
 
-		//set up textures:
+		//set up textures (units this drawable doesn't use are left empty, as if each drawable started afresh):
 		for (uint32_t i = 0; i < Drawable::Pipeline::TextureCount; ++i) {
-			if (pipeline.textures[i].texture != 0) {
-				glActiveTexture(GL_TEXTURE0 + i);
-				glBindTexture(pipeline.textures[i].target, pipeline.textures[i].texture);
-			}
+			Drawable::Pipeline::TextureInfo const &want = pipeline.textures[i];
+			Drawable::Pipeline::TextureInfo &have = current_textures[i];
+			if (want.texture == have.texture && (want.texture == 0 || want.target == have.target)) continue;
+			if (have.texture != 0 && (want.texture == 0 || want.target != have.target)) bind_texture(i, have.target, 0);
+			if (want.texture != 0) bind_texture(i, want.target, want.texture);
+			have = want;
 		}
 
 		//draw the object:
 		glDrawArrays(pipeline.type, pipeline.start, pipeline.count);
+	}
 
-		//un-bind textures:
-		for (uint32_t i = 0; i < Drawable::Pipeline::TextureCount; ++i) {
-			if (pipeline.textures[i].texture != 0) {
-				glActiveTexture(GL_TEXTURE0 + i);
-				glBindTexture(pipeline.textures[i].target, 0);
-			}
-		}
-		glActiveTexture(GL_TEXTURE0);
-
+	//un-bind textures:
+	for (uint32_t i = 0; i < Drawable::Pipeline::TextureCount; ++i) {
+		if (current_textures[i].texture != 0) bind_texture(i, current_textures[i].target, 0);
 	}
+	glActiveTexture(GL_TEXTURE0);
 
 	glUseProgram(0);
 	glBindVertexArray(0);
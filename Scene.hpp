@@ -12,10 +12,12 @@
 
 #include "GL.hpp"
 #include "Mesh.hpp"
+#include "UniformBlocks.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <functional>
@@ -45,6 +47,27 @@ struct Scene {
 		// ..relative to the world:
 		glm::mat4x3 make_local_to_world() const;
 		glm::mat4x3 make_world_to_local() const;
+		//NOTE: the world matrices are cached, and only rebuilt when position, rotation, scale, or parent of this
+		// transform (or of anything above it) differ from what they were built from
+
+		//-- internals --
+		struct WorldCache {
+			uint64_t revision = 0; //changes on every rebuild; 0 => never built
+			uint64_t pass = 0; //last Scene::update_transforms() pass this was checked in
+			//what local_to_world was built from:
+			Transform const *parent = nullptr;
+			uint64_t parent_revision = 0;
+			glm::vec3 position = glm::vec3(0.0f);
+			glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+			glm::vec3 scale = glm::vec3(1.0f);
+			glm::mat4x3 local_to_world = glm::mat4x3(1.0f);
+			glm::mat4x3 world_to_local = glm::mat4x3(1.0f); //built on first use after each rebuild
+			bool has_world_to_local = false;
+		};
+		mutable WorldCache world_cache;
+		//bring world_cache (and the caches of all parents, first) up to date; pass != 0 skips anything already
+		// checked during that pass:
+		void update_world_cache(uint64_t pass = 0) const;
 
 		//since hierarchy is tracked through pointers, copy-constructing a transform  is not advised:
 		Transform(Transform const &) = delete;
@@ -57,6 +80,10 @@ struct Scene {
 		Drawable(Transform *transform_) : transform(transform_) { assert(transform); }
 		Transform * transform;
 
+		//bounding sphere in local space (xyz center, w radius), so draw() can skip drawables that are out of view;
+		// a negative radius means the bounds aren't known, and the drawable is always drawn:
+		glm::vec4 bounds = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+
 		std::function< void() > set_uniforms; 
 
 		//Contains all the data needed to run the OpenGL pipeline:
@@ -74,6 +101,8 @@ struct Scene {
 			GLuint OBJECT_TO_CLIP_mat4 = -1U; //uniform location for object to clip space matrix
 			GLuint OBJECT_TO_LIGHT_mat4x3 = -1U; //uniform location for object to light space (== world space) matrix
 			GLuint NORMAL_TO_LIGHT_mat3 = -1U; //uniform location for normal to light space (== world space) matrix
+			//..or, if set, the program reads all three from its Object uniform block instead (see UniformBlocks.hpp):
+			bool object_uniforms = false;
 
 			std::function< void() > set_uniforms; //(optional) function to set any other useful uniforms
 
@@ -137,11 +166,32 @@ struct Scene {
 	std::list< Camera > cameras;
 	std::list< Light > lights;
 
+	//bring every transform's cached world matrices up to date in one parents-first pass (draw() starts with this):
+	void update_transforms() const;
+
 	//The "draw" function provides a convenient way to pass all the things in a scene to OpenGL:
 	void draw(Camera const &camera) const;
 
 	//..sometimes, you want to draw with a custom projection matrix and/or light space:
 	void draw(glm::mat4 const &world_to_clip, glm::mat4x3 const &world_to_light = glm::mat4x3(1.0f)) const;
+	//NOTE: drawables are submitted sorted by program, vertex array, and textures (then nearest first), not in list
+	// order, and bindings shared with the previous drawable aren't re-sent; so set_uniforms functions should only
+	// set uniforms, and shouldn't count on any other drawable's uniforms having been set before theirs
+	//NOTE: drawables whose bounds are entirely outside the view aren't submitted at all
+
+	//reused by draw() from frame to frame:
+	struct QueuedDrawable {
+		Drawable const *drawable;
+		glm::mat4x3 object_to_world;
+		float depth; //distance in front of the camera
+	};
+	mutable std::vector< QueuedDrawable > render_queue;
+	struct CullBatch { //world-space bounding spheres of each queued drawable, as parallel arrays for Frustum
+		std::vector< float > x, y, z, radius;
+		std::vector< uint8_t > visible;
+	};
+	mutable CullBatch cull_batch;
+	mutable std::vector< ObjectUniforms > object_uniforms; //transforms of each queued drawable, in queue order
 
 	//add transforms/objects/cameras from a scene file to this scene:
 	// the 'on_drawable' callback gives your code a chance to look up mesh data and make Drawables:
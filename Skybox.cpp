@@ -3,7 +3,6 @@
 #include "GL.hpp"
 #include "SkyboxProgram.hpp"
 #include "data_path.hpp"
-#include "glm/gtc/type_ptr.hpp"
 #include "stb_image.h"
 
 //largely inspired by https://learnopengl.com/Advanced-OpenGL/Cubemaps
@@ -97,13 +96,10 @@ Skybox::Skybox() {
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 }
 
-void Skybox::draw(Scene::Camera *cam){
+void Skybox::draw(){
 	glDepthFunc(GL_LEQUAL);
 	glUseProgram(skybox_program->program);
 
-	glUniformMatrix4fv(skybox_program->VIEW_mat4, 1, GL_FALSE, glm::value_ptr(glm::mat4(glm::mat3(cam->transform->make_world_to_local())))); 
-	glUniformMatrix4fv(skybox_program->PROJECTION_mat4, 1, GL_FALSE, glm::value_ptr(cam->make_projection())); 
-
     glBindVertexArray(skyboxVAO);
     glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
     glDrawArrays(GL_TRIANGLES, 0, 36);
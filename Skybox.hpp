@@ -6,5 +6,5 @@
 struct Skybox {
 	GLuint texture, skyboxVAO, skyboxVBO;
 	Skybox();
-	void draw(Scene::Camera *cam);
+	void draw(); //with the camera last given to set_frame_uniforms()
 };
@@ -1,5 +1,6 @@
 #include "SkyboxProgram.hpp"
 
+#include "UniformBlocks.hpp"
 #include "gl_compile_program.hpp"
 #include "gl_errors.hpp"
 
@@ -12,11 +13,10 @@ SkyboxProgram::SkyboxProgram() {
 		"#version 330\n"
 		"layout (location = 0) in vec3 aPos;\n"
 		"out vec3 TexCoords;\n"
-		"uniform mat4 projection;\n"
-		"uniform mat4 view;\n"
+		FRAME_UNIFORMS_GLSL
 		"void main() {\n"
 		"	TexCoords = aPos;\n"
-		"	vec4 pos = projection * view * vec4(aPos, 1.0);\n"
+		"	vec4 pos = PROJECTION * mat4(mat3(WORLD_TO_VIEW)) * vec4(aPos, 1.0);\n" //rotation only: always centered on the camera
 		"	gl_Position = pos.xyww;\n"
 		"}\n"
 	,
@@ -34,9 +34,8 @@ SkyboxProgram::SkyboxProgram() {
 
 	//look up the locations of vertex attributes:
 
-	//look up the locations of uniforms:
-	PROJECTION_mat4 = glGetUniformLocation(program, "projection");
-	VIEW_mat4 = glGetUniformLocation(program, "view");
+	//camera comes from a uniform block:
+	connect_uniform_blocks(program);
 }
 
 SkyboxProgram::~SkyboxProgram() {
@@ -10,9 +10,8 @@ struct SkyboxProgram {
 
 	GLuint program = 0;
 	//Attribute (per-vertex variable) locations:
-	//Uniform (per-invocation variable) locations:
-	GLuint PROJECTION_mat4 = -1U;
-	GLuint VIEW_mat4 = -1U;
+	//Uniform blocks (see UniformBlocks.hpp):
+	// Frame - PROJECTION and WORLD_TO_VIEW
 	//Textures:
 	// none
 };
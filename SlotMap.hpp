@@ -0,0 +1,106 @@
+#pragma once
+
+/*
+ * Generational slot map: values live densely in one array (so iterating them is a straight run through memory), and
+ * are referred to by handles that stay valid until that value is erased.
+ *
+ * Erasing moves the last value into the hole, so it is O(1), but it does move a value: pointers into the map are
+ * only good until the next emplace() or erase(). Handles carry the generation of their slot, so a handle to an
+ * erased value is detected (get() returns nullptr) even once the slot has been reused.
+ *
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template< typename T >
+struct SlotMap {
+	struct Handle {
+		uint32_t slot = ~uint32_t(0);
+		uint32_t generation = 0;
+		bool operator==(Handle const &other) const { return slot == other.slot && generation == other.generation; }
+		bool operator!=(Handle const &other) const { return !(*this == other); }
+	};
+
+	template< typename... Args >
+	Handle emplace(Args &&... args) {
+		uint32_t slot;
+		if (!free_slots.empty()) {
+			slot = free_slots.back();
+			free_slots.pop_back();
+		} else {
+			slot = static_cast< uint32_t >(slots.size());
+			slots.emplace_back();
+		}
+		slots[slot].dense = static_cast< uint32_t >(values.size());
+		values.emplace_back(std::forward< Args >(args)...);
+		slot_of.emplace_back(slot);
+		return Handle{ slot, slots[slot].generation };
+	}
+
+	//remove the value behind handle, moving the last value into its place:
+	void erase(Handle handle) {
+		assert(contains(handle));
+		uint32_t i = slots[handle.slot].dense;
+		uint32_t last = static_cast< uint32_t >(values.size()) - 1;
+		if (i != last) {
+			values[i] = std::move(values[last]);
+			slot_of[i] = slot_of[last];
+			slots[slot_of[i]].dense = i;
+		}
+		values.pop_back();
+		slot_of.pop_back();
+
+		slots[handle.slot].generation++; //outstanding handles to this slot are now stale
+		free_slots.emplace_back(handle.slot);
+	}
+
+	void clear() {
+		for (uint32_t slot : slot_of) {
+			slots[slot].generation++;
+			free_slots.emplace_back(slot);
+		}
+		values.clear();
+		slot_of.clear();
+	}
+
+	bool contains(Handle handle) const {
+		return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation;
+	}
+	T *get(Handle handle) { return contains(handle) ? &values[slots[handle.slot].dense] : nullptr; }
+	T const *get(Handle handle) const { return contains(handle) ? &values[slots[handle.slot].dense] : nullptr; }
+
+	//handle of the value at position i of the dense array:
+	Handle handle_at(size_t i) const {
+		assert(i < values.size());
+		return Handle{ slot_of[i], slots[slot_of[i]].generation };
+	}
+
+	size_t size() const { return values.size(); }
+	bool empty() const { return values.empty(); }
+	void reserve(size_t count) {
+		values.reserve(count);
+		slot_of.reserve(count);
+	}
+
+	T &operator[](size_t i) { return values[i]; }
+	T const &operator[](size_t i) const { return values[i]; }
+	T &back() { return values.back(); }
+	typename std::vector< T >::iterator begin() { return values.begin(); }
+	typename std::vector< T >::iterator end() { return values.end(); }
+	typename std::vector< T >::const_iterator begin() const { return values.begin(); }
+	typename std::vector< T >::const_iterator end() const { return values.end(); }
+
+	//-- internals --
+	struct Slot {
+		uint32_t dense = 0; //index into values while the slot is live
+		uint32_t generation = 0; //bumped whenever the slot's value is erased
+	};
+	std::vector< T > values;
+	std::vector< uint32_t > slot_of; //dense index -> slot
+	std::vector< Slot > slots;
+	std::vector< uint32_t > free_slots;
+};
@@ -0,0 +1,129 @@
+#include "SpatialHash.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+//segment queries that would walk more cells than this (per entry stored) just test every entry instead;
+// fast beams at high dilation can span most of the system in one step
+static double constexpr MaxCellsPerEntry = 4.0;
+
+SpatialHash::Key SpatialHash::key_of(int64_t cx, int64_t cy) const {
+	return (static_cast< uint64_t >(static_cast< uint32_t >(cx)) << 32) | static_cast< uint32_t >(cy);
+}
+
+int64_t SpatialHash::cell_of(double coord) const {
+	//clamp so far-flung entities share edge cells rather than overflowing the key
+	double c = std::floor(coord / cell_size);
+	c = std::max(-2147483648.0, std::min(2147483647.0, c));
+	return static_cast< int64_t >(c);
+}
+
+void SpatialHash::update(Id id, glm::dvec3 const &pos, double radius) {
+	Key key = key_of(cell_of(pos.x), cell_of(pos.y));
+	max_radius = std::max(max_radius, radius);
+
+	auto found = entries.find(id);
+	if (found != entries.end()) {
+		if (found->second.key == key) { //same cell, just keep its copy of the position current
+			cells.at(key)[found->second.index].pos = glm::dvec2(pos);
+			return;
+		}
+		remove(id);
+	}
+	std::vector< Item > &cell = cells[key];
+	entries.emplace(id, Entry{ key, static_cast< uint32_t >(cell.size()) });
+	cell.emplace_back(Item{ id, glm::dvec2(pos) });
+}
+
+void SpatialHash::remove(Id id) {
+	auto found = entries.find(id);
+	if (found == entries.end()) return;
+
+	auto cell = cells.find(found->second.key);
+	assert(cell != cells.end());
+	std::vector< Item > &items = cell->second;
+	uint32_t index = found->second.index;
+	assert(index < items.size() && items[index].id == id);
+	if (index + 1 != items.size()) { //move the last item into the hole
+		items[index] = items.back();
+		entries.at(items[index].id).index = index;
+	}
+	items.pop_back();
+	if (items.empty()) cells.erase(cell);
+
+	entries.erase(found);
+}
+
+void SpatialHash::clear() {
+	entries.clear();
+	cells.clear();
+	max_radius = 0.0;
+}
+
+//squared distance from p to the segment a-b, in the plane:
+static double segment_distance2(glm::dvec2 const &p, glm::dvec2 const &a, glm::dvec2 const &b) {
+	glm::dvec2 ab = b - a;
+	double len2 = glm::dot(ab, ab);
+	double t = (len2 > 0.0 ? glm::clamp(glm::dot(p - a, ab) / len2, 0.0, 1.0) : 0.0);
+	glm::dvec2 d = p - (a + t * ab);
+	return glm::dot(d, d);
+}
+
+void SpatialHash::gather(int64_t x0, int64_t x1, int64_t y0, int64_t y1, glm::dvec3 const &a, glm::dvec3 const &b,
+	double radius, std::vector< Id > &out) const {
+	const glm::dvec2 a2(a), b2(b);
+	const double r2 = radius * radius;
+	for (int64_t cx = x0; cx <= x1; cx++) {
+		for (int64_t cy = y0; cy <= y1; cy++) {
+			auto cell = cells.find(key_of(cx, cy));
+			if (cell == cells.end()) continue;
+			for (Item const &item : cell->second) {
+				if (segment_distance2(item.pos, a2, b2) <= r2) out.emplace_back(item.id);
+			}
+		}
+	}
+}
+
+void SpatialHash::query_sphere(glm::dvec3 const &center, double radius, std::vector< Id > &out) const {
+	query_segment(center, center, radius, out);
+}
+
+void SpatialHash::query_segment(glm::dvec3 const &a, glm::dvec3 const &b, double radius,
+	std::vector< Id > &out) const {
+	if (entries.empty()) return;
+	radius += max_radius;
+
+	//walk the segment in slabs one cell wide along x, visiting the cells its inflated span covers in y:
+	glm::dvec3 lo = a, hi = b;
+	if (lo.x > hi.x) std::swap(lo, hi);
+	const int64_t x0 = cell_of(lo.x - radius);
+	const int64_t x1 = cell_of(hi.x + radius);
+	const bool vertical = !(hi.x > lo.x);
+	const double dy_dx = (vertical ? 0.0 : (hi.y - lo.y) / (hi.x - lo.x));
+	const double slab_span = (vertical ? std::abs(hi.y - lo.y)
+		: std::min((cell_size + 2.0 * radius) * std::abs(dy_dx), std::abs(hi.y - lo.y))) + 2.0 * radius;
+	const double walk = static_cast< double >(x1 - x0 + 1) * (slab_span / cell_size + 2.0);
+	if (walk > MaxCellsPerEntry * static_cast< double >(entries.size())) {
+		//cheaper to test everything:
+		const glm::dvec2 a2(a), b2(b);
+		const double r2 = radius * radius;
+		for (auto const &cell : cells) {
+			for (Item const &item : cell.second) {
+				if (segment_distance2(item.pos, a2, b2) <= r2) out.emplace_back(item.id);
+			}
+		}
+		return;
+	}
+
+	for (int64_t cx = x0; cx <= x1; cx++) {
+		//range of x covered by this slab, clipped to the segment, widened by radius:
+		double sx0 = std::max(lo.x, cx * cell_size - radius);
+		double sx1 = std::min(hi.x, (cx + 1) * cell_size + radius);
+		sx0 = std::min(sx0, hi.x);
+		sx1 = std::max(sx1, lo.x);
+		double ya = (vertical ? lo.y : lo.y + (sx0 - lo.x) * dy_dx);
+		double yb = (vertical ? hi.y : lo.y + (sx1 - lo.x) * dy_dx);
+		gather(cx, cx, cell_of(std::min(ya, yb) - radius), cell_of(std::max(ya, yb) + radius), a, b, radius, out);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+/*
+ * Uniform grid broadphase over the orbital plane, hashed so only occupied cells take memory.
+ *
+ * Entries are opaque ids chosen by the caller (e.g. generational handles, so that an id left over from something
+ * since removed can be recognized as stale when it is resolved) with a position and radius given on update().
+ * Each entry sits in the cell holding its center; queries widen by the largest radius stored, so entries bigger
+ * than a cell are still found. update() only moves an entry between cells when it changes cell, so keeping it
+ * current every step costs a lookup per entry. Queries return candidates; callers still run their exact test on them.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct SpatialHash {
+	explicit SpatialHash(double cell_size_ = 10.0) : cell_size(cell_size_) {}
+
+	typedef uint64_t Id;
+
+	//insert id at pos, or move it there:
+	void update(Id id, glm::dvec3 const &pos, double radius);
+	void remove(Id id);
+	void clear();
+	size_t size() const { return entries.size(); }
+
+	//ids that may lie within radius of center (appended to out):
+	void query_sphere(glm::dvec3 const &center, double radius, std::vector< Id > &out) const;
+	//ids that may lie within radius of the segment from a to b (appended to out):
+	void query_segment(glm::dvec3 const &a, glm::dvec3 const &b, double radius, std::vector< Id > &out) const;
+
+	double cell_size; //Megameters
+
+	//-- internals --
+	typedef uint64_t Key;
+	Key key_of(int64_t cx, int64_t cy) const;
+	int64_t cell_of(double coord) const;
+	//append everything in cells [x0,x1] x [y0,y1] within radius of the segment a-b:
+	void gather(int64_t x0, int64_t x1, int64_t y0, int64_t y1, glm::dvec3 const &a, glm::dvec3 const &b, double radius,
+		std::vector< Id > &out) const;
+
+	struct Item { //what a cell holds per entry, so queries needn't look anything up
+		Id id;
+		glm::dvec2 pos;
+	};
+	struct Entry {
+		Key key; //cell
+		uint32_t index; //in that cell's items
+	};
+	std::unordered_map< Id, Entry > entries;
+	std::unordered_map< Key, std::vector< Item > > cells;
+	double max_radius = 0.0; //of anything ever inserted since the last clear()
+};
@@ -18,17 +18,12 @@ struct TexturedPlanetProgram {
 	GLuint TexCoord_vec2 = -1U;
 
 	//Uniform (per-invocation variable) locations:
-	GLuint OBJECT_TO_CLIP_mat4 = -1U;
-	GLuint OBJECT_TO_LIGHT_mat4x3 = -1U;
+	GLuint OBJECT_TO_LIGHT_mat4x3 = -1U; //light space is world space
 	GLuint NORMAL_TO_LIGHT_mat3 = -1U;
 
-	//lighting:
-	GLuint LIGHT_LOCATION_vec3 = -1U;
-	GLuint AMBIENT_COLOR_vec3 = -1U;
-	GLuint LIGHT_DIRECTION_vec3 = -1U;
-	GLuint LIGHT_ENERGY_vec3 = -1U;
-	GLuint LIGHT_CUTOFF_float = -1U;
-	
+	//Uniform blocks (see UniformBlocks.hpp):
+	// Frame - WORLD_TO_CLIP and lighting
+
 	//Textures:
 	//TEXTURE0 - texture that is accessed by TexCoord
 };
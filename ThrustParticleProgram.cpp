@@ -0,0 +1,64 @@
+#include "ThrustParticleProgram.hpp"
+
+#include "UniformBlocks.hpp"
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+Load< ThrustParticleProgram > thrust_particle_program(LoadTagEarly);
+
+ThrustParticleProgram::ThrustParticleProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		FRAME_UNIFORMS_GLSL
+		"uniform float TIME;\n"
+		"uniform float SCALE;\n"
+		"in vec4 Position;\n"
+		"in vec3 SpawnPosition;\n"
+		"in float SpawnTime;\n"
+		"in vec3 Velocity;\n"
+		"in float LifeTime;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		"	float age = TIME - SpawnTime;\n"
+		"	float a = 1.0 - age / LifeTime;\n" //fraction of life left
+		"	if (age < 0.0 || a <= 0.0) {\n" //not spawned yet, or burnt out: collapse out of view
+		"		gl_Position = vec4(0.0, 0.0, 0.0, 0.0);\n"
+		"		color = vec4(0.0);\n"
+		"		return;\n"
+		"	}\n"
+		"	vec3 position = SpawnPosition + Velocity * age + (SCALE * a) * Position.xyz;\n"
+		"	gl_Position = WORLD_TO_CLIP * vec4(position, 1.0);\n"
+		"	color = vec4(1.0, 1.0 - a, 0.0, 1.0);\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"in vec4 color;\n"
+		"layout (location = 0) out vec4 fragColor;\n"
+		"layout (location = 1) out vec4 brightColor;\n"
+		"void main() {\n"
+		"	fragColor = color;\n"
+		"	brightColor = color;\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Position_vec4 = glGetAttribLocation(program, "Position");
+	SpawnPosition_vec3 = glGetAttribLocation(program, "SpawnPosition");
+	SpawnTime_float = glGetAttribLocation(program, "SpawnTime");
+	Velocity_vec3 = glGetAttribLocation(program, "Velocity");
+	LifeTime_float = glGetAttribLocation(program, "LifeTime");
+
+	//the camera comes from a uniform block:
+	connect_uniform_blocks(program);
+
+	//look up the locations of uniforms:
+	TIME_float = glGetUniformLocation(program, "TIME");
+	SCALE_float = glGetUniformLocation(program, "SCALE");
+}
+
+ThrustParticleProgram::~ThrustParticleProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "GL.hpp"
+#include "Load.hpp"
+
+//Shader program for rocket exhaust (see ThrustParticles): every particle is an instance whose attributes are only
+// where, when and how it was spawned; its current position, size and color are worked out from its age against TIME
+struct ThrustParticleProgram {
+	ThrustParticleProgram();
+	~ThrustParticleProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-vertex variable) locations:
+	GLuint Position_vec4 = -1U;
+
+	//Attribute (per-instance variable) locations:
+	GLuint SpawnPosition_vec3 = -1U; //world space
+	GLuint SpawnTime_float = -1U; //seconds, on the same clock as TIME
+	GLuint Velocity_vec3 = -1U; //world space, per second
+	GLuint LifeTime_float = -1U; //seconds, shrinking to nothing (and red to yellow) over it
+
+	//Uniform (per-invocation variable) locations:
+	GLuint TIME_float = -1U;
+	GLuint SCALE_float = -1U; //size at spawn
+
+	//Uniform blocks (see UniformBlocks.hpp):
+	// Frame - WORLD_TO_CLIP
+};
+
+extern Load< ThrustParticleProgram > thrust_particle_program;
@@ -0,0 +1,121 @@
+#include "ThrustParticles.hpp"
+#include "ThrustParticleProgram.hpp"
+
+#include "gl_errors.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+ThrustParticles::ThrustParticles(MeshBuffer const &meshes, Mesh const &mesh_, uint32_t capacity, float scale_)
+	: scale(scale_), mesh(mesh_) {
+	glm::vec4 sphere = mesh_bounding_sphere(mesh);
+	mesh_radius = (sphere.w < 0.0f ? 0.0f : glm::length(glm::vec3(sphere)) + sphere.w);
+
+	ring.resize(capacity);
+	clear();
+
+	glGenBuffers(1, &instance_buffer);
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	//the mesh gives each particle its shape:
+	glBindBuffer(GL_ARRAY_BUFFER, meshes.buffer);
+	MeshBuffer::Attrib const &position = meshes.Position;
+	glVertexAttribPointer(thrust_particle_program->Position_vec4, position.size, position.type, position.normalized, position.stride, (GLbyte *)0 + position.offset);
+	glEnableVertexAttribArray(thrust_particle_program->Position_vec4);
+
+	//..and the ring says where and when each one was spawned:
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	glBufferData(GL_ARRAY_BUFFER, ring.size() * sizeof(Spawn), nullptr, GL_DYNAMIC_DRAW);
+	auto bind_instance = [&](GLuint location, GLint size, size_t offset) {
+		glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, sizeof(Spawn), (GLbyte *)0 + offset);
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	};
+	bind_instance(thrust_particle_program->SpawnPosition_vec3, 3, offsetof(Spawn, position));
+	bind_instance(thrust_particle_program->SpawnTime_float, 1, offsetof(Spawn, time));
+	bind_instance(thrust_particle_program->Velocity_vec3, 3, offsetof(Spawn, velocity));
+	bind_instance(thrust_particle_program->LifeTime_float, 1, offsetof(Spawn, life_time));
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	GL_ERRORS();
+}
+
+ThrustParticles::~ThrustParticles() {
+	glDeleteVertexArrays(1, &vao);
+	vao = 0;
+	glDeleteBuffers(1, &instance_buffer);
+	instance_buffer = 0;
+}
+
+void ThrustParticles::spawn(glm::vec3 const &position, glm::vec3 const &velocity, float life_time) {
+	if (ring.empty()) return;
+	ring[next] = Spawn{ position, static_cast< float >(time), velocity, life_time };
+	next = (next + 1) % ring.size();
+	dirty = true;
+}
+
+void ThrustParticles::advance(double elapsed) {
+	time += elapsed;
+	if (time > RebaseTime) {
+		time -= RebaseTime;
+		for (Spawn &spawn : ring) {
+			spawn.time -= static_cast< float >(RebaseTime);
+		}
+		dirty = true;
+	}
+}
+
+void ThrustParticles::clear() {
+	for (Spawn &spawn : ring) { //long dead, as far as the shader can tell
+		spawn = Spawn{ glm::vec3(0.0f), -static_cast< float >(RebaseTime), glm::vec3(0.0f), 1.0f };
+	}
+	next = 0;
+	time = 0.0;
+	dirty = true;
+}
+
+void ThrustParticles::draw(Frustum const &frustum) const {
+	if (ring.empty() || mesh.count == 0) return;
+
+	if (dirty) { //the whole ring is only a few kilobytes, so re-send it rather than track which slots changed
+		glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, ring.size() * sizeof(Spawn), ring.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		//..and, while walking it anyway, re-fit the bounds:
+		float const now = static_cast< float >(time);
+		bounds_min = glm::vec3( std::numeric_limits< float >::infinity());
+		bounds_max = glm::vec3(-std::numeric_limits< float >::infinity());
+		live_until = now;
+		for (Spawn const &spawn : ring) {
+			float end = spawn.time + spawn.life_time;
+			if (!(end > now)) continue;
+			glm::vec3 last = spawn.position + spawn.velocity * spawn.life_time;
+			bounds_min = glm::min(bounds_min, glm::min(spawn.position, last));
+			bounds_max = glm::max(bounds_max, glm::max(spawn.position, last));
+			live_until = std::max(live_until, end);
+		}
+		bounds_min -= glm::vec3(scale * mesh_radius);
+		bounds_max += glm::vec3(scale * mesh_radius);
+
+		dirty = false;
+	}
+
+	//nothing left burning, or nothing in view:
+	if (!(static_cast< float >(time) < live_until)) return;
+	if (!frustum.box_visible(bounds_min, bounds_max)) return;
+
+	glUseProgram(thrust_particle_program->program);
+	glUniform1f(thrust_particle_program->TIME_float, static_cast< float >(time));
+	glUniform1f(thrust_particle_program->SCALE_float, scale);
+	glBindVertexArray(vao);
+	glDrawArraysInstanced(mesh.type, mesh.start, mesh.count, GLsizei(ring.size()));
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	GL_ERRORS();
+}
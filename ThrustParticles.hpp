@@ -0,0 +1,64 @@
+#pragma once
+
+/*
+ * Rocket exhaust drawn entirely on the GPU: the CPU only writes a particle's spawn state (position, velocity, time,
+ * lifetime) into a ring of instances when it is emitted, and ThrustParticleProgram moves, shrinks and fades every
+ * particle from its age in one instanced draw. Nothing is touched per particle per frame, so denser exhaust costs no
+ * CPU time.
+ *
+ */
+
+#include "GL.hpp"
+#include "Mesh.hpp"
+#include "Frustum.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+struct ThrustParticles {
+	//capacity particles at once, each drawn as mesh (at scale when spawned):
+	ThrustParticles(MeshBuffer const &meshes, Mesh const &mesh, uint32_t capacity, float scale);
+	~ThrustParticles();
+
+	//owns GL objects, so copying isn't meaningful:
+	ThrustParticles(ThrustParticles const &) = delete;
+	ThrustParticles &operator=(ThrustParticles const &) = delete;
+
+	//emit a particle now, overwriting the oldest once all capacity is in use:
+	void spawn(glm::vec3 const &position, glm::vec3 const &velocity, float life_time);
+	//move the clock on by elapsed seconds:
+	void advance(double elapsed);
+	void clear(); //drop every particle
+	//draw with the camera last given to set_frame_uniforms(), unless no live particle could be in frustum:
+	void draw(Frustum const &frustum) const;
+
+	//-- internals --
+	struct Spawn {
+		glm::vec3 position;
+		float time;
+		glm::vec3 velocity;
+		float life_time;
+	};
+	static_assert(sizeof(Spawn) == 8*4, "Spawn is packed.");
+
+	//the clock is rebased once it passes this, so spawn times keep their precision as floats:
+	static double constexpr RebaseTime = 1000.0;
+
+	std::vector< Spawn > ring;
+	uint32_t next = 0; //slot the next spawn goes in
+	double time = 0.0;
+	float scale;
+
+	Mesh mesh;
+	float mesh_radius; //of a sphere around the mesh's origin enclosing it
+	GLuint vao = 0;
+	GLuint instance_buffer = 0;
+	mutable bool dirty = true; //ring changed since it was last uploaded
+
+	//box around the paths of every particle live as of the last upload (particles only die off until the ring next
+	// changes, so it stays conservative until then), and the time the last of them burns out:
+	mutable glm::vec3 bounds_min = glm::vec3(0.0f);
+	mutable glm::vec3 bounds_max = glm::vec3(0.0f);
+	mutable float live_until = 0.0f;
+};
@@ -0,0 +1,67 @@
+#include "UniformBlocks.hpp"
+
+#include "Load.hpp"
+#include "gl_errors.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+//n.b. declared static so they don't conflict with similarly named global variables elsewhere:
+static GLuint frame_buffer = 0;
+static GLuint object_buffer = 0;
+static GLsizeiptr object_capacity = 0; //bytes allocated for object_buffer
+static GLsizeiptr object_stride = 0; //sizeof(ObjectUniforms), rounded up to where glBindBufferRange may start
+static std::vector< uint8_t > object_staging; //objects laid out at object_stride, reused between uploads
+
+static Load< void > setup_buffers(LoadTagDefault, [](){
+	glGenBuffers(1, &frame_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, frame_buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FrameUniformsBinding, frame_buffer);
+
+	glGenBuffers(1, &object_buffer);
+	GLint alignment = 1;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	alignment = std::max(alignment, 1);
+	object_stride = (GLsizeiptr(sizeof(ObjectUniforms)) + alignment - 1) / alignment * alignment;
+
+	GL_ERRORS(); //PARANOIA: make sure nothing strange happened during setup
+});
+
+void connect_uniform_blocks(GLuint program) {
+	GLuint frame = glGetUniformBlockIndex(program, "Frame");
+	if (frame != GL_INVALID_INDEX) glUniformBlockBinding(program, frame, FrameUniformsBinding);
+	GLuint object = glGetUniformBlockIndex(program, "Object");
+	if (object != GL_INVALID_INDEX) glUniformBlockBinding(program, object, ObjectUniformsBinding);
+}
+
+void set_frame_uniforms(FrameUniforms const &frame) {
+	glBindBuffer(GL_UNIFORM_BUFFER, frame_buffer);
+	//fresh storage (orphaning last frame's) rather than wait for the GPU to finish reading it:
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &frame, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void set_object_uniforms(std::vector< ObjectUniforms > const &objects) {
+	if (objects.empty()) return;
+
+	object_staging.resize(objects.size() * object_stride);
+	for (size_t i = 0; i < objects.size(); ++i) {
+		std::memcpy(object_staging.data() + i * object_stride, &objects[i], sizeof(ObjectUniforms));
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, object_buffer);
+	GLsizeiptr size = GLsizeiptr(object_staging.size());
+	//grow geometrically, so a rising count doesn't reallocate every frame:
+	if (size > object_capacity) object_capacity = std::max(size, 2 * object_capacity);
+	glBufferData(GL_UNIFORM_BUFFER, object_capacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, size, object_staging.data());
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void bind_object_uniforms(size_t index) {
+	glBindBufferRange(GL_UNIFORM_BUFFER, ObjectUniformsBinding, object_buffer, GLintptr(index * object_stride),
+		GLsizeiptr(sizeof(ObjectUniforms)));
+}
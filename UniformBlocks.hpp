@@ -0,0 +1,72 @@
+#pragma once
+
+/*
+ * Uniform blocks shared between shader programs, so values that are the same for a whole frame (camera, light)
+ * or that Scene::draw computes for every drawable (transforms) reach the GPU in one buffer upload each, rather
+ * than through separate glUniform* calls on every program and drawable.
+ *
+ * A program using a block splices its declaration (FRAME_UNIFORMS_GLSL / OBJECT_UNIFORMS_GLSL) into its shader
+ * source and calls connect_uniform_blocks() once compiled. The structs below mirror the std140 layout.
+ *
+ */
+
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+//binding points the blocks are attached to:
+enum : GLuint {
+	FrameUniformsBinding = 0,
+	ObjectUniformsBinding = 1,
+};
+
+//camera and light for the frame, see set_frame_uniforms():
+#define FRAME_UNIFORMS_GLSL \
+	"layout(std140) uniform Frame {\n" \
+	"	mat4 WORLD_TO_CLIP;\n" \
+	"	mat4 WORLD_TO_VIEW;\n" \
+	"	mat4 PROJECTION;\n" \
+	"	vec3 LIGHT_LOCATION;\n" \
+	"	vec3 LIGHT_DIRECTION;\n" \
+	"	vec3 LIGHT_ENERGY;\n" \
+	"	vec3 AMBIENT_COLOR;\n" \
+	"};\n"
+
+struct FrameUniforms {
+	glm::mat4 WORLD_TO_CLIP = glm::mat4(1.0f);
+	glm::mat4 WORLD_TO_VIEW = glm::mat4(1.0f); //world to camera space (the camera looks down -z)
+	glm::mat4 PROJECTION = glm::mat4(1.0f); //camera space to clip space
+	//(std140 pads each vec3 out to 16 bytes)
+	glm::vec4 LIGHT_LOCATION = glm::vec4(0.0f);
+	glm::vec4 LIGHT_DIRECTION = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+	glm::vec4 LIGHT_ENERGY = glm::vec4(1.0f);
+	glm::vec4 AMBIENT_COLOR = glm::vec4(0.0f);
+};
+static_assert(sizeof(FrameUniforms) == 3*4*16 + 4*16, "FrameUniforms matches the std140 layout of Frame.");
+
+//transforms of one drawable, see Scene::draw():
+#define OBJECT_UNIFORMS_GLSL \
+	"layout(std140) uniform Object {\n" \
+	"	mat4 OBJECT_TO_CLIP;\n" \
+	"	mat4x3 OBJECT_TO_LIGHT;\n" \
+	"	mat3 NORMAL_TO_LIGHT;\n" \
+	"};\n"
+
+struct ObjectUniforms {
+	glm::mat4 OBJECT_TO_CLIP;
+	glm::mat4 OBJECT_TO_LIGHT; //(std140 pads each column of a mat4x3 out to a vec4, so only xyz is read)
+	glm::vec4 NORMAL_TO_LIGHT[3]; //columns of a mat3, padded likewise
+};
+static_assert(sizeof(ObjectUniforms) == 2*4*16 + 3*16, "ObjectUniforms matches the std140 layout of Object.");
+
+//attach whichever of the blocks above program declares to their binding points:
+void connect_uniform_blocks(GLuint program);
+
+//upload the frame's camera and light, for every program that reads Frame:
+void set_frame_uniforms(FrameUniforms const &frame);
+
+//upload transforms for many drawables at once, then pick which one Object refers to with bind_object_uniforms():
+void set_object_uniforms(std::vector< ObjectUniforms > const &objects);
+void bind_object_uniforms(size_t index);
@@ -4,6 +4,7 @@
 #include "GL.hpp"
 #include "load_save_png.hpp"
 #include "ShowSceneProgram.hpp"
+#include "Frustum.hpp"
 
 #include <SDL.h>
 
@@ -121,6 +122,7 @@ int main(int argc, char **argv) {
 				drawable.pipeline.start = mesh.start;
 				drawable.pipeline.count = mesh.count;
 
+				drawable.bounds = mesh_bounding_sphere(mesh);
 			});
 		} catch (std::exception &e) {
 			std::cerr << "ERROR loading scene '" << scene_file << "': " << e.what() << std::endl;